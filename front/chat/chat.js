@@ -1,5 +1,5 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Variables add by server:
+// Variables set by the room page:
 // - urlWebsocket
 // - urlRoom
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -17,7 +17,12 @@ let CODE_FILE_CHUNK_DATA = 8;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-let socket = new WebSocket(urlWebsocket);
+// encrypt outgoing chat messages with the room Rabin key when the browser has BigInt
+let rabinEncryption = typeof BigInt === "function";
+let rabinKey = null;
+let rabinBits = 0;
+
+let socket = new WebSocket(urlWebsocket + (rabinEncryption ? "?encryption=rabin" : ""));
 let peedId = null;
 let peerName = null;
 let peersMap = new Map();
@@ -91,6 +96,70 @@ function setupEmoji (){
     }
 }
 
+function jacobi(a, n) {
+    let result = 1;
+    a %= n;
+    while(a !== 0n) {
+        while((a & 1n) === 0n) {
+            a >>= 1n;
+            let r = n & 7n;
+            if(r === 3n || r === 5n) result = -result;
+        }
+        [a, n] = [n, a];
+        if((a & 3n) === 3n && (n & 3n) === 3n) result = -result;
+        a %= n;
+    }
+    return n === 1n ? result : 0;
+}
+
+// Rabin frame, same format as server RabinCodec: 'R' 'B' version bits:u16 length:u64, then blocks of
+// (bits - 2) / 8 bytes - 8 zero redundancy bytes and the payload, each encrypted as c = m^2 (mod n)
+// with the Jacobi symbol of m in bit `bits`. The server rejects blocks without the redundancy.
+function rabinEncode(text) {
+
+    let bytes = new TextEncoder().encode(text);
+    let blockBytes = Math.floor((rabinBits - 2) / 8);
+    let payloadSize = blockBytes - Math.min(8, blockBytes - 1);
+    let wireBlockSize = Math.floor(rabinBits / 8) + 1;
+    let blocks = Math.ceil(bytes.length / payloadSize);
+    let frame = new Uint8Array(13 + blocks * wireBlockSize);
+
+    frame[0] = 0x52;
+    frame[1] = 0x42;
+    frame[2] = 2;
+    frame[3] = rabinBits >> 8;
+    frame[4] = rabinBits & 0xFF;
+    let length = bytes.length;
+    for(let i = 12; i >= 5; i --) {
+        frame[i] = length % 256;
+        length = Math.floor(length / 256);
+    }
+
+    for(let block = 0; block < blocks; block ++) {
+        let m = 0n;
+        for(let i = 0; i < payloadSize; i ++) {
+            let pos = block * payloadSize + i;
+            m = (m << 8n) | BigInt(pos < bytes.length ? bytes[pos] : 0);
+        }
+        let c = m * m % rabinKey;
+        if(jacobi(m, rabinKey) < 0) {
+            c |= 1n << BigInt(rabinBits);
+        }
+        let end = 13 + (block + 1) * wireBlockSize;
+        for(let i = 1; i <= wireBlockSize; i ++) {
+            frame[end - i] = Number(c & 0xFFn);
+            c >>= 8n;
+        }
+    }
+
+    let binary = "";
+    for(let i = 0; i < frame.length; i ++) {
+        binary += String.fromCharCode(frame[i]);
+    }
+    return btoa(binary);
+
+}
+
 function postChatMessage(message) {
 
     removeTypingPeerNow(message.peerId);
@@ -556,6 +625,12 @@ document.forms.publish.onsubmit = function() {
     let text = outgoingMessage.replace(/\s/g,''); // check if text not empty (remove all whitespaces)
 
     if(text !== "") {
+        if(rabinEncryption) {
+            if(rabinKey === null) {
+                return false; // room key is not received yet
+            }
+            outgoingMessage = rabinEncode(outgoingMessage);
+        }
         let message = {
             peerId: peerId,
             peerName: peerName,
@@ -571,48 +646,11 @@ document.forms.publish.onsubmit = function() {
 
 document.getElementById('chat_input').addEventListener("keypress", function (e) {
     if(e.which == 13 && !e.shiftKey) {
-        var inputValue = document.getElementById('chat_input').value;
         document.forms.publish.onsubmit();
         e.preventDefault();
-        // Get the value of the chat input
-        
-
-        // Get the current base URL from the window.location object
-        var baseUrl = getCurrentBaseUrl();
-
-        // Get the current roomId from the URL
-        var roomId = getCurrentRoomId();
-
-        var xhr = new XMLHttpRequest();
-        
-        // Construct the URL dynamically
-        var apiUrl = baseUrl + "/room/encrypt/" + roomId + "/" + peerName + "/" + encodeURIComponent(inputValue);
-        xhr.open("GET", apiUrl, true);
-
-        xhr.onreadystatechange = function () {
-            if (xhr.readyState == 4) {
-                if (xhr.status == 200) {
-                    // Handle the response from the server if needed
-                    console.log("Server response:", xhr.responseText);
-                } else {
-                    // Handle errors
-                    console.error("Error:", xhr.statusText);
-                }
-            }
-        };
-
-        xhr.send();
     }
 });
-function getCurrentBaseUrl() {
-    return window.location.protocol + "//" + window.location.host;
-}
-function getCurrentRoomId() {
-    var pathParts = window.location.pathname.split('/');
-    if(pathParts[pathParts.length - 1]!='')
-        return pathParts[pathParts.length - 1];
-    else return pathParts[pathParts.length - 2]
-}
+
 document.getElementById('chat_input').addEventListener("input", function () {
 
     let now = (new Date()).getTime();
@@ -649,6 +687,11 @@ function onMessage(message) {
             peerId = message.peerId;
             peerName = message.peerName;
 
+            if(rabinEncryption && message.roomKey) {
+                rabinKey = BigInt("0x" + message.roomKey);
+                rabinBits = rabinKey.toString(2).length;
+            }
+
             for (let index = 0; index < message.peers.length; index++) {
                 let peer = message.peers[index];
                 peersMap.set(peer.peerId, peer);
@@ -691,7 +734,10 @@ function onMessage(message) {
             break;
 
         case CODE_PEER_IS_TYPING:
-            postPeerIsTyping(message)
+            // the server sends one message per tick listing everyone who is typing in the room
+            for(let typingPeer of (message.peers || [message])) {
+                postPeerIsTyping(typingPeer);
+            }
             break;
 
         case CODE_PEER_MESSAGE_FILE:
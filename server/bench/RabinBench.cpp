@@ -0,0 +1,350 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "rabin/rabin.hpp"
+#include "rabin/FixedRabinKey.hpp"
+#include "rabin/RabinKeyGenerator.hpp"
+
+#include <openssl/crypto.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+/*
+ * Rabin crypto benchmarks. Prints one JSON document to stdout:
+ *  - "crypto" - RabinCryptosystem encrypt/decrypt (per byte, machine-word keys only) and encode/decode
+ *    (framed) for message sizes from 16 B to `maxSize` and small-int and big-int keys.
+ *    Reports ns/op, ns/byte, ops/sec and heap allocations per call (operator new and OpenSSL allocations).
+ *  - "decrypt_batch" - per-element decryptBlock() loop against decryptBatch().
+ *  - "runtime_vs_fixed" - runtime key (RabinKey) against compile-time key (FixedRabinKey) with the same primes.
+ * Usage: canchat-bench [threads] [maxSize], threads = 0 - all hardware threads, maxSize defaults to 1 MB.
+ */
+
+namespace {
+
+std::atomic<uint64_t> allocations(0);
+
+void* countedMalloc(size_t size, const char* file, int line) {
+  (void) file;
+  (void) line;
+  ++ allocations;
+  return std::malloc(size);
+}
+
+void* countedRealloc(void* ptr, size_t size, const char* file, int line) {
+  (void) file;
+  (void) line;
+  ++ allocations;
+  return std::realloc(ptr, size);
+}
+
+void countedFree(void* ptr, const char* file, int line) {
+  (void) file;
+  (void) line;
+  std::free(ptr);
+}
+
+}
+
+void* operator new(size_t size) {
+  ++ allocations;
+  void* result = std::malloc(size == 0 ? 1 : size);
+  if(!result) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+typedef FixedRabinKey<2147483647ULL, 2147483587ULL> FixedKey;
+
+/* each measurement runs for at least this long */
+constexpr double MIN_MEASURE_NS = 200e6;
+
+double elapsedNs(Clock::time_point start) {
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+/*
+ * Measurement of one operation.
+ */
+struct Sample {
+  uint64_t iterations;
+  double nsPerOp;
+  double allocsPerOp;
+};
+
+/*
+ * Call `func` once to warm up, then repeatedly until MIN_MEASURE_NS has passed.
+ */
+template<typename F>
+Sample measure(const F& func) {
+  func();
+  Sample sample;
+  sample.iterations = 0;
+  uint64_t allocStart = allocations;
+  auto start = Clock::now();
+  double ns = 0;
+  do {
+    func();
+    ++ sample.iterations;
+    ns = elapsedNs(start);
+  } while(ns < MIN_MEASURE_NS);
+  sample.nsPerOp = ns / sample.iterations;
+  sample.allocsPerOp = (double) (allocations - allocStart) / sample.iterations;
+  return sample;
+}
+
+class JsonArray {
+private:
+  bool m_first;
+public:
+
+  JsonArray(const char* name)
+    : m_first(true)
+  {
+    std::cout << "  \"" << name << "\": [";
+  }
+
+  void next() {
+    std::cout << (m_first ? "\n    " : ",\n    ");
+    m_first = false;
+  }
+
+  void close(bool last) {
+    std::cout << "\n  ]" << (last ? "\n" : ",\n");
+  }
+
+};
+
+void printCrypto(JsonArray& array, const char* op, const char* backend, int keyBits, size_t size, const Sample& sample, bool ok) {
+  array.next();
+  std::cout << "{\"op\": \"" << op << "\""
+            << ", \"backend\": \"" << backend << "\""
+            << ", \"key_bits\": " << keyBits
+            << ", \"size\": " << size
+            << ", \"iterations\": " << sample.iterations
+            << ", \"ns_per_op\": " << sample.nsPerOp
+            << ", \"ns_per_byte\": " << sample.nsPerOp / size
+            << ", \"ops_per_sec\": " << 1e9 / sample.nsPerOp
+            << ", \"allocs_per_call\": " << sample.allocsPerOp
+            << ", \"ok\": " << (ok ? "true" : "false") << "}";
+}
+
+std::string makePlaintext(size_t size) {
+  std::string result(size, '\0');
+  for(size_t i = 0; i < size; i ++) {
+    result[i] = (char) ('a' + i % 26);
+  }
+  return result;
+}
+
+void runCrypto(JsonArray& array, const std::shared_ptr<const RabinKey>& key, size_t size) {
+
+  std::string plaintext = makePlaintext(size);
+  RabinCryptosystem cryptosystem(key, plaintext);
+  int bits = cryptosystem.getCodec().getBackend()->getModulusBits();
+
+  std::vector<RabinKey::WordType> c(size);
+  Sample sample = measure([&] {
+    for(size_t i = 0; i < size; i ++) {
+      c[i] = cryptosystem.encrypt((uint8_t) plaintext[i]);
+    }
+  });
+  printCrypto(array, "encrypt", "small", bits, size, sample, true);
+
+  bool ok = true;
+  sample = measure([&] {
+    for(size_t i = 0; i < size; i ++) {
+      ok = ok && cryptosystem.decrypt(c[i]) == (uint8_t) plaintext[i];
+    }
+  });
+  printCrypto(array, "decrypt", "small", bits, size, sample, ok);
+
+}
+
+void runCodec(JsonArray& array, RabinCryptosystem& cryptosystem, const char* backend, const std::string& plaintext) {
+
+  int bits = cryptosystem.getCodec().getBackend()->getModulusBits();
+
+  Sample sample = measure([&] {
+    cryptosystem.encode();
+  });
+  printCrypto(array, "encode", backend, bits, plaintext.size(), sample, true);
+
+  bool ok = true;
+  sample = measure([&] {
+    ok = ok && cryptosystem.decode() == plaintext;
+  });
+  printCrypto(array, "decode", backend, bits, plaintext.size(), sample, ok);
+
+}
+
+void runDecrypt(JsonArray& array, const RabinKey& key, size_t count, unsigned threads) {
+
+  std::vector<uint64_t> c(count);
+  std::vector<int8_t> jacobi(count);
+  std::vector<uint64_t> m(count);
+  uint64_t step = key.getN() / 2 / count;
+  for(size_t i = 0; i < count; i ++) {
+    m[i] = i * step + i % 251;
+    c[i] = key.encrypt(m[i]);
+    jacobi[i] = (int8_t) key.jacobi(m[i]);
+  }
+
+  std::vector<uint64_t> out(count);
+
+  auto start = Clock::now();
+  for(size_t i = 0; i < count; i ++) {
+    out[i] = key.decryptBlock(c[i], jacobi[i]);
+  }
+  double loopNs = elapsedNs(start);
+  bool loopOk = out == m;
+
+  start = Clock::now();
+  key.decryptBatch(c.data(), jacobi.data(), count, out.data(), threads);
+  double batchNs = elapsedNs(start);
+  bool batchOk = out == m;
+
+  array.next();
+  std::cout << "{\"count\": " << count
+            << ", \"loop_ns_per_op\": " << loopNs / count
+            << ", \"batch_ns_per_op\": " << batchNs / count
+            << ", \"speedup\": " << loopNs / batchNs
+            << ", \"ok\": " << ((loopOk && batchOk) ? "true" : "false") << "}";
+
+}
+
+template<class Key>
+double measureKey(const Key& key, const std::vector<uint64_t>& c, const std::vector<int8_t>& jacobi, std::vector<uint64_t>& out) {
+  auto start = Clock::now();
+  for(size_t i = 0; i < c.size(); i ++) {
+    out[i] = key.decryptBlock(c[i], jacobi[i]);
+  }
+  return elapsedNs(start) / c.size();
+}
+
+void runRuntimeVsFixed(JsonArray& array, const RabinKey& key, const FixedKey& fixed, size_t count) {
+
+  std::vector<uint64_t> c(count);
+  std::vector<int8_t> jacobi(count);
+  std::vector<uint64_t> m(count);
+  uint64_t step = key.getN() / 2 / count;
+  for(size_t i = 0; i < count; i ++) {
+    m[i] = i * step + i % 251;
+    c[i] = key.encrypt(m[i]);
+    jacobi[i] = (int8_t) key.jacobi(m[i]);
+  }
+
+  std::vector<uint64_t> out(count);
+  double runtimeNs = measureKey(key, c, jacobi, out);
+  bool runtimeOk = out == m;
+  double fixedNs = measureKey(fixed, c, jacobi, out);
+  bool fixedOk = out == m;
+
+  array.next();
+  std::cout << "{\"count\": " << count
+            << ", \"runtime_ns_per_op\": " << runtimeNs
+            << ", \"fixed_ns_per_op\": " << fixedNs
+            << ", \"speedup\": " << runtimeNs / fixedNs
+            << ", \"ok\": " << ((runtimeOk && fixedOk) ? "true" : "false") << "}";
+
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+
+  /* must be set before OpenSSL allocates anything */
+  CRYPTO_set_mem_functions(countedMalloc, countedRealloc, countedFree);
+
+  unsigned threads = argc > 1 ? (unsigned) std::atoi(argv[1]) : 0;
+  size_t maxSize = argc > 2 ? (size_t) std::atoll(argv[2]) : 1024 * 1024;
+
+  std::vector<std::shared_ptr<const RabinKey>> smallKeys;
+  smallKeys.push_back(std::make_shared<RabinKey>(RabinKeyGenerator::generateBlumPrime(16), RabinKeyGenerator::generateBlumPrime(17)));
+  smallKeys.push_back(std::make_shared<RabinKey>(RabinKeyGenerator::generateBlumPrime(31), RabinKeyGenerator::generateBlumPrime(30)));
+
+  std::vector<std::shared_ptr<const RabinBackend>> bigKeys;
+  bigKeys.push_back(RabinKeyGenerator::generate(1024));
+  bigKeys.push_back(RabinKeyGenerator::generate(2048));
+
+  std::cout << "{\n";
+
+  JsonArray crypto("crypto");
+  for(size_t size = 16; size <= maxSize; size *= 16) {
+    std::string plaintext = makePlaintext(size);
+    for(auto& key : smallKeys) {
+      runCrypto(crypto, key, size);
+      RabinCryptosystem cryptosystem(key, plaintext);
+      runCodec(crypto, cryptosystem, "small", plaintext);
+    }
+    for(auto& key : bigKeys) {
+      RabinCryptosystem cryptosystem(key, plaintext);
+      runCodec(crypto, cryptosystem, "big", plaintext);
+    }
+  }
+  crypto.close(false);
+
+  RabinKey key(2147483647ULL, 2147483587ULL);
+  const size_t counts[] = {1000, 100000, 10000000};
+
+  JsonArray batch("decrypt_batch");
+  for(size_t count : counts) {
+    runDecrypt(batch, key, count, threads);
+  }
+  batch.close(false);
+
+  FixedKey fixed;
+  JsonArray runtimeVsFixed("runtime_vs_fixed");
+  for(size_t count : counts) {
+    runRuntimeVsFixed(runtimeVsFixed, key, fixed, count);
+  }
+  runtimeVsFixed.close(true);
+
+  std::cout << "}\n";
+
+  return 0;
+}
@@ -28,6 +28,7 @@
 #include "controller/FileController.hpp"
 #include "controller/RoomsController.hpp"
 #include "controller/StaticController.hpp"
+#include "controller/RabinController.hpp"
 
 #include "./AppComponent.hpp"
 
@@ -48,6 +49,7 @@ void run(const oatpp::base::CommandLineArguments& args) {
   router->addController(std::make_shared<StaticController>());
   router->addController(std::make_shared<FileController>());
   router->addController(std::make_shared<StatisticsController>());
+  router->addController(std::make_shared<RabinController>());
 
   /* Get connection handler component */
   OATPP_COMPONENT(std::shared_ptr<oatpp::network::ConnectionHandler>, connectionHandler, "http");
@@ -67,6 +69,12 @@ void run(const oatpp::base::CommandLineArguments& args) {
     lobby->runPingLoop(std::chrono::seconds(30));
   });
 
+  std::thread roomTickThread([]{
+    OATPP_COMPONENT(std::shared_ptr<Lobby>, lobby);
+    OATPP_COMPONENT(oatpp::Object<ConfigDto>, appConfig);
+    lobby->runRoomTickLoop(std::chrono::milliseconds(*appConfig->typingTickMs));
+  });
+
   std::thread statThread([]{
     OATPP_COMPONENT(std::shared_ptr<Statistics>, statistics);
     statistics->runStatLoop();
@@ -85,6 +93,7 @@ void run(const oatpp::base::CommandLineArguments& args) {
 
   serverThread.join();
   pingThread.join();
+  roomTickThread.join();
   statThread.join();
 
 }
@@ -30,6 +30,10 @@
 #include "rooms/Lobby.hpp"
 #include "dto/Config.hpp"
 #include "utils/Statistics.hpp"
+#include "utils/RabinKeyPool.hpp"
+#include "utils/ComputePool.hpp"
+#include "utils/AssetStore.hpp"
+#include "rabin/RabinWilliamsKey.hpp"
 
 #include "oatpp-openssl/server/ConnectionProvider.hpp"
 
@@ -115,6 +119,8 @@ public:
       config->tlsCertificateChainPath = m_cmdArgs.getNamedArgumentValue("--tls-chain", "" CERT_CRT_PATH);
     }
 
+    config->signMessages = std::getenv("SIGN_MESSAGES") != nullptr || m_cmdArgs.hasArgument("--sign-messages");
+
     config->statisticsUrl = std::getenv("URL_STATS_PATH");
     if(!config->statisticsUrl) {
       config->statisticsUrl = m_cmdArgs.getNamedArgumentValue("--url-stats", "admin/stats.json");
@@ -191,6 +197,48 @@ public:
     return std::make_shared<Statistics>();
   }());
 
+  /**
+   *  Create pool of per-room Rabin keys.
+   */
+  OATPP_CREATE_COMPONENT(std::shared_ptr<RabinKeyPool>, rabinKeyPool)([] {
+    OATPP_COMPONENT(oatpp::Object<ConfigDto>, appConfig);
+    return std::make_shared<RabinKeyPool>(appConfig->rabinKeyBits, appConfig->rabinKeyPoolSize, appConfig->rabinKeyPoolThreads);
+  }());
+
+  /**
+   *  Create store of precompressed, content-hashed front assets.
+   */
+  OATPP_CREATE_COMPONENT(std::shared_ptr<AssetStore>, assetStore)([] {
+    OATPP_COMPONENT(oatpp::Object<ConfigDto>, appConfig);
+    auto store = std::make_shared<AssetStore>(FRONT_PATH);
+    store->setVariable("WEBSOCKET_BASE_URL", appConfig->getWebsocketBaseUrl());
+    store->setUrlVariable("CHAT_JS_URL", "chat/chat.js");
+    store->load();
+    if(appConfig->watchFrontAssets) {
+      store->startWatching();
+    }
+    return store;
+  }());
+
+  /**
+   *  Create thread pool for CPU-heavy crypto work.
+   */
+  OATPP_CREATE_COMPONENT(std::shared_ptr<ComputePool>, computePool)([] {
+    OATPP_COMPONENT(oatpp::Object<ConfigDto>, appConfig);
+    return std::make_shared<ComputePool>(appConfig->computePoolThreads, appConfig->computeQueueCapacity);
+  }());
+
+  /**
+   *  Create server message signing key. nullptr if signing is disabled.
+   */
+  OATPP_CREATE_COMPONENT(std::shared_ptr<RabinWilliamsKey>, signingKey)([] {
+    OATPP_COMPONENT(oatpp::Object<ConfigDto>, appConfig);
+    if(!appConfig->signMessages) {
+      return std::shared_ptr<RabinWilliamsKey>();
+    }
+    return RabinWilliamsKey::generate(appConfig->signingKeyBits);
+  }());
+
   /**
    *  Create chat lobby component.
    */
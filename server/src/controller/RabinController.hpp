@@ -0,0 +1,221 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinController_hpp
+#define RabinController_hpp
+
+#include "dto/Config.hpp"
+#include "rooms/Lobby.hpp"
+#include "utils/ComputePool.hpp"
+
+#include "oatpp/web/server/api/ApiController.hpp"
+#include "oatpp/encoding/Base64.hpp"
+#include "oatpp/core/utils/ConversionUtils.hpp"
+
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/macro/component.hpp"
+
+#include <vector>
+
+#include OATPP_CODEGEN_BEGIN(ApiController) /// <-- Begin Code-Gen
+
+/**
+ * Batch encryption with room Rabin keys. <br>
+ * `POST api/rabin/encrypt?roomId=...` takes a batch of messages and returns the ciphertexts in the same order and format:
+ * <ul>
+ *   <li>`application/json` - array of strings. Ciphertexts are base64 Rabin frames (see `RabinCodec`).</li>
+ *   <li>`application/octet-stream` - records of 4-byte big-endian length followed by raw bytes.</li>
+ * </ul>
+ * Encryption runs on the `ComputePool`. <br>
+ * There is no decryption endpoint. Room members still get their decrypted messages echoed back by the room,
+ * so the codec only returns roots carrying the block redundancy (see `RabinCodec`) - a wrong root, which would
+ * factor the room modulus, is rejected instead of being published.
+ */
+class RabinController : public oatpp::web::server::api::ApiController {
+private:
+  typedef RabinController __ControllerType;
+private:
+  OATPP_COMPONENT(oatpp::Object<ConfigDto>, m_appConfig);
+  OATPP_COMPONENT(std::shared_ptr<Lobby>, m_lobby);
+  OATPP_COMPONENT(std::shared_ptr<ComputePool>, m_computePool);
+private:
+
+  static bool readBinaryBatch(const oatpp::String& body, std::vector<oatpp::String>& items) {
+    auto data = (const v_uint8*) body->data();
+    v_buff_size size = (v_buff_size) body->size();
+    v_buff_size pos = 0;
+    while(pos < size) {
+      if(size - pos < 4) {
+        return false;
+      }
+      v_buff_size length = ((v_buff_size) data[pos] << 24) | (data[pos + 1] << 16) | (data[pos + 2] << 8) | data[pos + 3];
+      pos += 4;
+      if(size - pos < length) {
+        return false;
+      }
+      items.push_back(oatpp::String((const char*) data + pos, length));
+      pos += length;
+    }
+    return true;
+  }
+
+  static oatpp::String writeBinaryBatch(const std::vector<oatpp::String>& items) {
+    oatpp::data::stream::BufferOutputStream stream;
+    for(auto& item : items) {
+      v_uint32 length = (v_uint32) item->size();
+      v_uint8 prefix[4] = {(v_uint8) (length >> 24), (v_uint8) (length >> 16), (v_uint8) (length >> 8), (v_uint8) length};
+      stream.writeSimple(prefix, 4);
+      stream.writeSimple(item->data(), (v_buff_size) item->size());
+    }
+    return stream.toString();
+  }
+
+  /**
+   * Reject bodies without `Content-Length` or larger than `maxRabinBatchBytes` - before reading them.
+   */
+  void checkBodySize(const std::shared_ptr<IncomingRequest>& request) {
+    auto contentLength = request->getHeader(Header::CONTENT_LENGTH);
+    OATPP_ASSERT_HTTP(contentLength, Status::CODE_411, "Content-Length required.");
+    bool success;
+    v_uint64 length = oatpp::utils::conversion::strToUInt64(contentLength, success);
+    OATPP_ASSERT_HTTP(success, Status::CODE_400, "Invalid Content-Length.");
+    OATPP_ASSERT_HTTP(length <= *m_appConfig->maxRabinBatchBytes, Status::CODE_413, "Batch is too large.");
+  }
+
+  /*
+   * Batch request - parsed and answered on the coroutine, transformed on the compute pool.
+   */
+  struct Batch {
+    std::shared_ptr<Room> room;
+    std::vector<oatpp::String> items;
+    bool binary;
+    bool valid;
+  };
+
+  std::shared_ptr<Batch> readBatch(const std::shared_ptr<IncomingRequest>& request, oatpp::String body) {
+
+    if(!body) {
+      body = "";
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->room = m_lobby->getRoom(request->getQueryParameter("roomId"));
+    OATPP_ASSERT_HTTP(batch->room, Status::CODE_404, "Room not found");
+
+    auto contentType = request->getHeader(Header::CONTENT_TYPE);
+    batch->binary = contentType && contentType->find("application/octet-stream") == 0;
+    batch->valid = true;
+
+    if(batch->binary) {
+      OATPP_ASSERT_HTTP(readBinaryBatch(body, batch->items), Status::CODE_400, "Malformed binary batch.");
+    } else {
+      oatpp::List<oatpp::String> list;
+      try {
+        list = getDefaultObjectMapper()->readFromString<oatpp::List<oatpp::String>>(body);
+      } catch (const std::runtime_error& e) {
+        list = nullptr;
+      }
+      OATPP_ASSERT_HTTP(list, Status::CODE_400, "Expected JSON array of strings.");
+      batch->items.reserve(list->size());
+      for(auto& item : *list) {
+        OATPP_ASSERT_HTTP(item, Status::CODE_400, "Batch item is null.");
+        batch->items.push_back(item);
+      }
+    }
+
+    return batch;
+
+  }
+
+  /*
+   * Encrypt all items in place. Runs on the compute pool.
+   */
+  static void encryptBatch(Batch& batch) {
+    const RabinCodec& codec = batch.room->getCodec();
+    try {
+      for(auto& item : batch.items) {
+        std::string frame = codec.encode(item->data(), item->size());
+        item = batch.binary ? oatpp::String(std::move(frame)) : oatpp::encoding::Base64::encode(frame.data(), (v_buff_size) frame.size());
+      }
+    } catch (const std::runtime_error& e) {
+      batch.valid = false;
+    }
+  }
+
+  std::shared_ptr<OutgoingResponse> writeBatch(const Batch& batch) {
+
+    OATPP_ASSERT_HTTP(batch.valid, Status::CODE_400, "Can't encrypt batch.");
+
+    if(batch.binary) {
+      auto response = createResponse(Status::CODE_200, writeBinaryBatch(batch.items));
+      response->putHeader(Header::CONTENT_TYPE, "application/octet-stream");
+      return response;
+    }
+
+    auto list = oatpp::List<oatpp::String>::createShared();
+    for(auto& item : batch.items) {
+      list->push_back(item);
+    }
+    return createDtoResponse(Status::CODE_200, list);
+
+  }
+
+public:
+  RabinController(OATPP_COMPONENT(std::shared_ptr<ObjectMapper>, objectMapper))
+    : oatpp::web::server::api::ApiController(objectMapper)
+  {}
+public:
+
+  ENDPOINT_ASYNC("POST", "api/rabin/encrypt", Encrypt) {
+
+    ENDPOINT_ASYNC_INIT(Encrypt)
+
+    std::shared_ptr<Batch> m_batch;
+
+    Action act() override {
+      controller->checkBodySize(request);
+      return request->readBodyToStringAsync().callbackTo(&Encrypt::onBody);
+    }
+
+    Action onBody(const oatpp::String& body) {
+      m_batch = controller->readBatch(request, body);
+      auto batch = m_batch;
+      return controller->m_computePool->execute([batch] {
+        encryptBatch(*batch);
+      }).next(yieldTo(&Encrypt::onDone));
+    }
+
+    Action onDone() {
+      return _return(controller->writeBatch(*m_batch));
+    }
+
+  };
+
+};
+
+#include OATPP_CODEGEN_END(ApiController) /// <-- End Code-Gen
+
+#endif // RabinController_hpp
@@ -62,6 +62,10 @@ public:
 
       OATPP_ASSERT_HTTP(nickname, Status::CODE_400, "No nickname specified.");
 
+      /* optional in-band encryption of chat messages, "rabin" - with the room key */
+      auto encryption = request->getQueryParameter("encryption");
+      OATPP_ASSERT_HTTP(!encryption || encryption == "rabin", Status::CODE_400, "Unknown encryption mode.");
+
       /* Websocket handshake */
       auto response = oatpp::websocket::Handshaker::serversideHandshake(request->getHeaders(), controller->websocketConnectionHandler);
 
@@ -69,6 +73,9 @@ public:
 
       (*parameters)["roomName"] = roomName;
       (*parameters)["nickname"] = nickname;
+      if(encryption) {
+        (*parameters)["encryption"] = encryption;
+      }
 
       /* Set connection upgrade params */
       response->setConnectionUpgradeParameters(parameters);
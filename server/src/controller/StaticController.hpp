@@ -27,31 +27,59 @@
 #ifndef StaticController_hpp
 #define StaticController_hpp
 
-#include "dto/Config.hpp"
+#include "utils/AssetStore.hpp"
+#include "utils/Statistics.hpp"
 #include "oatpp/web/server/api/ApiController.hpp"
 
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/core/macro/component.hpp"
 
-#include "rabin/rabin.hpp"
-
-#include <regex>
-
 #include OATPP_CODEGEN_BEGIN(ApiController) /// <-- Begin Code-Gen
 
 class StaticController : public oatpp::web::server::api::ApiController {
 private:
   typedef StaticController __ControllerType;
 private:
-  OATPP_COMPONENT(oatpp::Object<ConfigDto>, m_config);
   OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+  OATPP_COMPONENT(std::shared_ptr<AssetStore>, m_assetStore);
 private:
 
-  static oatpp::String loadFile(const char* filename) {
-    auto buffer = oatpp::String::loadFromFile(filename);
-    OATPP_ASSERT_HTTP(buffer, Status::CODE_404, "File Not Found:(");
-    return buffer;
+  /*
+   * Response with the variant of the asset picked by Accept-Encoding, or 304 if the client has it.
+   */
+  std::shared_ptr<OutgoingResponse> createAssetResponse(const std::shared_ptr<IncomingRequest>& request,
+                                                        const std::shared_ptr<const AssetStore::Asset>& asset,
+                                                        const char* cacheControl)
+  {
+
+    OATPP_ASSERT_HTTP(asset, Status::CODE_404, "File Not Found:(");
+
+    const auto& variant = AssetStore::selectVariant(*asset, request->getHeader("Accept-Encoding"));
+
+    std::shared_ptr<OutgoingResponse> response;
+    if(AssetStore::matchesETag(request->getHeader("If-None-Match"), variant.etag)) {
+      ++ m_statistics->EVENT_ASSET_NOT_MODIFIED;
+      response = OutgoingResponse::createShared(Status::CODE_304, nullptr);
+    } else {
+      switch(&variant - asset->variants) {
+        case AssetStore::ENCODING_BROTLI: ++ m_statistics->EVENT_ASSET_SERVED_BROTLI; break;
+        case AssetStore::ENCODING_GZIP: ++ m_statistics->EVENT_ASSET_SERVED_GZIP; break;
+        default: ++ m_statistics->EVENT_ASSET_SERVED_IDENTITY; break;
+      }
+      response = createResponse(Status::CODE_200, variant.body);
+      response->putHeader(Header::CONTENT_TYPE, asset->contentType);
+      if(variant.encoding) {
+        response->putHeader("Content-Encoding", variant.encoding);
+      }
+    }
+
+    response->putHeader("ETag", variant.etag);
+    response->putHeader("Vary", "Accept-Encoding");
+    response->putHeader("Cache-Control", cacheControl);
+    return response;
+
   }
+
 public:
   StaticController(OATPP_COMPONENT(std::shared_ptr<ObjectMapper>, objectMapper))
     : oatpp::web::server::api::ApiController(objectMapper)
@@ -64,57 +92,7 @@ public:
 
     Action act() override {
       ++ controller->m_statistics->EVENT_FRONT_PAGE_LOADED;
-      static auto fileCache = loadFile(FRONT_PATH "/index.html");
-      auto response = controller->createResponse(Status::CODE_200, fileCache);
-      response->putHeader(Header::CONTENT_TYPE, "text/html");
-      return _return(response);
-    }
-
-  };
-
-  ENDPOINT_ASYNC("GET", "/room/encrypt/{roomId}/{peerName}/{massage}", Encrypt) {
-
-    ENDPOINT_ASYNC_INIT(Encrypt)
-
-    Action act() override {
-      static auto fileCache = loadFile(FRONT_PATH "/index.html");
-      auto response = controller->createResponse(Status::CODE_200, fileCache);
-      response->putHeader(Header::CONTENT_TYPE, "text/html");
-      std::string massageValue = request->getPathVariable("massage");
-      std::string roomId = request->getPathVariable("roomId");
-      std::string peerName = request->getPathVariable("peerName");
-      std::string decodedString;
-      std::string peerNamedecode;
-      for (std::size_t i = 0; i < peerName.size(); ++i) {
-          if (peerName[i] == '%' && i + 2 < peerName.size()) {
-              int value;
-              if (sscanf(peerName.substr(i + 1, 2).c_str(), "%x", &value) == 1) {
-                  peerNamedecode += static_cast<char>(value);
-                  i += 2; // Move to the next triplet
-                  continue;
-              }
-          }
-        peerNamedecode += peerName[i];
-      }
-
-
-      for (std::size_t i = 0; i < massageValue.size(); ++i) {
-          if (massageValue[i] == '%' && i + 2 < massageValue.size()) {
-              int value;
-              if (sscanf(massageValue.substr(i + 1, 2).c_str(), "%x", &value) == 1) {
-                  decodedString += static_cast<char>(value);
-                  i += 2; // Move to the next triplet
-                  continue;
-              }
-          }
-        decodedString += massageValue[i];
-      }
-      
-      RabinCryptosystem cryptosystem(167, 151, decodedString);
-      OATPP_LOGI("Rabinchat", " Giá trị của massage tại phòng %s của %s trước khi mã hóa: %s", roomId.c_str(), peerNamedecode.c_str(), decodedString.c_str());
-      OATPP_LOGI("Rabinchat", " Giá trị của massage tại phòng %s của %s sau khi mã hóa: %s", roomId.c_str(), peerNamedecode.c_str(), cryptosystem.encode().c_str());
-      OATPP_LOGI("Rabinchat", " Giá trị của massage tại phòng %s của %s sau khi giải hóa: %s", roomId.c_str(), peerNamedecode.c_str(), cryptosystem.decode().c_str());
-      return _return(response);
+      return _return(controller->createAssetResponse(request, controller->m_assetStore->getByPath("index.html"), "no-cache"));
     }
 
   };
@@ -124,35 +102,18 @@ public:
     ENDPOINT_ASYNC_INIT(ChatHTML)
 
     Action act() override {
-      std::string fileCache = *loadFile(FRONT_PATH "/chat/index.html");
-      auto text = std::regex_replace(fileCache, std::regex("%%%ROOM_ID%%%"), *request->getPathVariable("roomId"));
-      auto response = controller->createResponse(Status::CODE_200, text);
-      response->putHeader(Header::CONTENT_TYPE, "text/html");
-      return _return(response);
+      return _return(controller->createAssetResponse(request, controller->m_assetStore->getByPath("chat/index.html"), "no-cache"));
     }
 
   };
 
-  ENDPOINT_ASYNC("GET", "room/{roomId}/chat.js", ChatJS) {
+  ENDPOINT_ASYNC("GET", "static/*", StaticAsset) {
 
-    ENDPOINT_ASYNC_INIT(ChatJS)
+    ENDPOINT_ASYNC_INIT(StaticAsset)
 
     Action act() override {
-      static auto fileCache = loadFile(FRONT_PATH "/chat/chat.js");
-
-      oatpp::data::stream::BufferOutputStream stream;
-
-      auto baseUrl = controller->m_config->getWebsocketBaseUrl();
-
-      stream << "let urlWebsocket = \"" << baseUrl << "/api/ws/room/" << request->getPathVariable("roomId") << "\";\n";
-      stream << "let urlRoom = \"/room/" << request->getPathVariable("roomId") << "\";\n";
-      stream << "\n";
-
-      stream << fileCache;
-
-      auto response = controller->createResponse(Status::CODE_200, stream.toString());
-      response->putHeader(Header::CONTENT_TYPE, "text/javascript");
-      return _return(response);
+      auto asset = controller->m_assetStore->getByName(request->getPathTail());
+      return _return(controller->createAssetResponse(request, asset, AssetStore::CACHE_CONTROL));
     }
 
   };
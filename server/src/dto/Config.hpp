@@ -62,11 +62,114 @@ public:
    */
   DTO_FIELD(UInt64, maxMessageSizeBytes) = 8 * 1024; // Default - 8Kb
 
+  /**
+   * Max number of outgoing frames queued for one peer. A peer whose queue overflows is disconnected.
+   */
+  DTO_FIELD(UInt32, maxPeerQueueFrames) = 1024;
+
+  /**
+   * Inbound rate limit of one peer - all messages except `CODE_FILE_CHUNK_DATA`. <br>
+   * Reading of a peer that exceeds the limit is deferred until it is back within the limit. `0` - unlimited.
+   */
+  DTO_FIELD(UInt32, peerMessagesPerSecond) = 50;
+  DTO_FIELD(UInt32, peerMessagesBurst) = 100;
+
+  /**
+   * Inbound rate limit of one peer for `CODE_FILE_CHUNK_DATA`, in bytes. <br>
+   * Chunks are paced by the server's `CODE_FILE_REQUEST_CHUNK`, so this only caps unsolicited chunks.
+   * Reading of a peer that exceeds the limit is deferred. `0` - unlimited.
+   */
+  DTO_FIELD(UInt32, peerFileChunkBytesPerSecond) = 16 * 1024 * 1024; // Default - 16Mb/s
+  DTO_FIELD(UInt32, peerFileChunkBytesBurst) = 1024 * 1024; // Default - 1Mb
+
+  /**
+   * Inbound rate limit of one peer for `CODE_PEER_MESSAGE`. A peer that exceeds the limit is disconnected. `0` - unlimited.
+   */
+  DTO_FIELD(UInt32, peerChatMessagesPerSecond) = 5;
+  DTO_FIELD(UInt32, peerChatMessagesBurst) = 20;
+
+  /**
+   * Inbound rate limit of one peer for `CODE_FILE_SHARE`. A peer that exceeds the limit is disconnected. `0` - unlimited.
+   */
+  DTO_FIELD(UInt32, peerFileSharesPerSecond) = 2;
+  DTO_FIELD(UInt32, peerFileSharesBurst) = 10;
+
+  /**
+   * Inbound rate limit of one peer for `CODE_PEER_IS_TYPING`. Typing messages over the limit are dropped. `0` - unlimited.
+   */
+  DTO_FIELD(UInt32, peerTypingPerSecond) = 2;
+  DTO_FIELD(UInt32, peerTypingBurst) = 4;
+
+  /**
+   * Room tick. Typing indicators are collected per room and sent as one message listing all typing peers once in this interval.
+   * Pending message chains are signed on the same tick.
+   */
+  DTO_FIELD(UInt32, typingTickMs) = 250;
+
   /**
    * Number of the most recent messages to keep in the room history.
    */
   DTO_FIELD(UInt32, maxRoomHistoryMessages) = 100;
 
+  /**
+   * Size of the modulus of per-room Rabin keys in bits.
+   * Larger than 62 bits - multi-precision (OpenSSL) keys.
+   * Up to 62 bits - machine-word keys. These are factored instantly - use them only in tests and benchmarks.
+   */
+  DTO_FIELD(UInt32, rabinKeyBits) = 2048;
+
+  /**
+   * Max size of request body of the batch encrypt/decrypt API.
+   */
+  DTO_FIELD(UInt64, maxRabinBatchBytes) = 1024 * 1024; // Default - 1Mb
+
+  /**
+   * Number of pre-generated Rabin keys kept ready for new rooms.
+   */
+  DTO_FIELD(UInt32, rabinKeyPoolSize) = 16;
+
+  /**
+   * Number of background threads generating Rabin keys.
+   */
+  DTO_FIELD(UInt32, rabinKeyPoolThreads) = 1;
+
+  /**
+   * Reload front assets when files under `FRONT_PATH` change.
+   */
+  DTO_FIELD(Boolean, watchFrontAssets) = true;
+
+  /**
+   * Number of threads running CPU-heavy crypto work. 0 - number of hardware threads.
+   */
+  DTO_FIELD(UInt32, computePoolThreads) = 0;
+
+  /**
+   * Max number of crypto jobs waiting for a compute thread. Further jobs are rejected.
+   */
+  DTO_FIELD(UInt32, computeQueueCapacity) = 1024;
+
+  /**
+   * Sign chat messages with the server Rabin-Williams key.
+   */
+  DTO_FIELD(Boolean, signMessages) = false;
+
+  /**
+   * Size of the modulus of the server signing key in bits.
+   */
+  DTO_FIELD(UInt32, signingKeyBits) = 1024;
+
+  /**
+   * Max number of chat messages covered by one signature.
+   * At high message rates only every N-th message carries a signature.
+   */
+  DTO_FIELD(UInt32, signEveryMessages) = 16;
+
+  /**
+   * A message is always signed if the last signature in the room is older than this.
+   * Unsigned messages of a room that went quiet are signed by the room tick (`typingTickMs`) once this passes.
+   */
+  DTO_FIELD(UInt32, signIntervalMs) = 200;
+
 public:
 
   oatpp::String getHostString() {
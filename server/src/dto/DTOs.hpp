@@ -45,7 +45,9 @@ ENUM(MessageCodes, v_int32,
   VALUE(CODE_FILE_REQUEST_CHUNK, 7),
   VALUE(CODE_FILE_CHUNK_DATA, 8),
 
-  VALUE(CODE_API_ERROR, 9)
+  VALUE(CODE_API_ERROR, 9),
+
+  VALUE(CODE_CHAIN_SIGNATURE, 10) // signature of the chain head when the room goes quiet, see MessageSigner
 );
 
 class PeerDto : public oatpp::DTO {
@@ -92,6 +94,15 @@ public:
 
   DTO_FIELD(List<Object<FileDto>>, files);
 
+  /* Signed message chain, see MessageSigner */
+
+  DTO_FIELD(Int64, seq);
+  DTO_FIELD(String, chain);     // hex
+  DTO_FIELD(String, signature); // hex, only on signed messages
+  DTO_FIELD(String, signingKey); // hex modulus of the server signing key, CODE_INFO only
+
+  DTO_FIELD(String, roomKey); // hex modulus of the room Rabin key, CODE_INFO only
+
 };
 
 class StatPointDto : public oatpp::DTO {
@@ -107,12 +118,39 @@ class StatPointDto : public oatpp::DTO {
   DTO_FIELD(UInt64, evPeerZombieDropped, "ev_peer_zombie_dropped");
   DTO_FIELD(UInt64, evPeerSendMessage, "ev_peer_send_message");
   DTO_FIELD(UInt64, evPeerShareFile, "ev_peer_share_file");
+  DTO_FIELD(UInt64, evSerializationSaved, "ev_serialization_saved");
+  DTO_FIELD(UInt64, evPeerRateDeferred, "ev_peer_rate_deferred");
+  DTO_FIELD(UInt64, evPeerRateLimited, "ev_peer_rate_limited");
+
+  DTO_FIELD(UInt64, peerOutboxFrames, "peer_outbox_frames");
+  DTO_FIELD(UInt64, peerOutboxMaxDepth, "peer_outbox_max_depth");
+  DTO_FIELD(UInt64, evPeerOutboxOverflow, "ev_peer_outbox_overflow");
+  DTO_FIELD(UInt64, evSocketWritesSaved, "ev_socket_writes_saved");
+  DTO_FIELD(UInt64, evEphemeralDropped, "ev_ephemeral_dropped");
 
   DTO_FIELD(UInt64, evRoomCreated, "ev_room_created");
   DTO_FIELD(UInt64, evRoomDeleted, "ev_room_deleted");
 
   DTO_FIELD(UInt64, fileServedBytes, "file_served_bytes");
 
+  DTO_FIELD(UInt64, evRabinKeyGenerated, "ev_rabin_key_generated");
+  DTO_FIELD(UInt64, evRabinKeyPoolMiss, "ev_rabin_key_pool_miss");
+  DTO_FIELD(UInt64, evMessageSigned, "ev_message_signed");
+
+  DTO_FIELD(UInt64, evComputeJobDone, "ev_compute_job_done");
+  DTO_FIELD(UInt64, evComputeJobRejected, "ev_compute_job_rejected");
+  DTO_FIELD(UInt64, computeWaitMicros, "compute_wait_micros");
+  DTO_FIELD(UInt64, computeQueueDepth, "compute_queue_depth");
+
+  DTO_FIELD(UInt64, assetBytesIdentity, "asset_bytes_identity");
+  DTO_FIELD(UInt64, assetBytesGzip, "asset_bytes_gzip");
+  DTO_FIELD(UInt64, assetBytesBrotli, "asset_bytes_brotli");
+  DTO_FIELD(UInt64, evAssetServedIdentity, "ev_asset_served_identity");
+  DTO_FIELD(UInt64, evAssetServedGzip, "ev_asset_served_gzip");
+  DTO_FIELD(UInt64, evAssetServedBrotli, "ev_asset_served_brotli");
+  DTO_FIELD(UInt64, evAssetNotModified, "ev_asset_not_modified");
+  DTO_FIELD(UInt64, evAssetReloaded, "ev_asset_reloaded");
+
 };
 
 #include OATPP_CODEGEN_END(DTO)
@@ -0,0 +1,280 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "BigRabinKey.hpp"
+
+#include <stdexcept>
+
+namespace {
+
+struct ThreadContext {
+
+  BN_CTX* ctx;
+
+  ThreadContext()
+    : ctx(BN_CTX_new())
+  {}
+
+  ~ThreadContext() {
+    BN_CTX_free(ctx);
+  }
+
+};
+
+void check(int result, const char* what) {
+  if(!result) {
+    throw std::runtime_error(std::string("[BigRabinKey]: Error. OpenSSL call failed - ") + what);
+  }
+}
+
+class ContextFrame {
+private:
+  BN_CTX* m_ctx;
+public:
+
+  ContextFrame(BN_CTX* ctx)
+    : m_ctx(ctx)
+  {
+    BN_CTX_start(m_ctx);
+  }
+
+  ~ContextFrame() {
+    BN_CTX_end(m_ctx);
+  }
+
+  BIGNUM* get() {
+    BIGNUM* result = BN_CTX_get(m_ctx);
+    check(result != nullptr, "BN_CTX_get");
+    return result;
+  }
+
+};
+
+}
+
+BN_CTX* BigRabinKey::getThreadContext() {
+  static thread_local ThreadContext context;
+  check(context.ctx != nullptr, "BN_CTX_new");
+  return context.ctx;
+}
+
+BigRabinKey::BigRabinKey(const BIGNUM* p, const BIGNUM* q)
+  : m_p(nullptr)
+  , m_q(nullptr)
+  , m_n(BN_new())
+  , m_expP(nullptr)
+  , m_expQ(nullptr)
+  , m_qInvR(BN_new())
+  , m_montP(BN_MONT_CTX_new())
+  , m_montQ(BN_MONT_CTX_new())
+  , m_montN(BN_MONT_CTX_new())
+{
+
+  try {
+
+    if(BN_mod_word(p, 4) != 3 || BN_mod_word(q, 4) != 3 || BN_cmp(p, q) == 0) {
+      throw std::runtime_error("[BigRabinKey::BigRabinKey()]: Error. Primes must be distinct and = 3 (mod 4).");
+    }
+
+    BN_CTX* ctx = getThreadContext();
+    bool pLarger = BN_cmp(p, q) > 0;
+
+    m_p = BN_dup(pLarger ? p : q);
+    m_q = BN_dup(pLarger ? q : p);
+    m_expP = BN_dup(m_p);
+    m_expQ = BN_dup(m_q);
+    check(m_p && m_q && m_n && m_expP && m_expQ && m_qInvR && m_montP && m_montQ && m_montN, "allocation");
+
+    check(BN_mul(m_n, m_p, m_q, ctx), "BN_mul");
+
+    check(BN_add_word(m_expP, 1) && BN_rshift(m_expP, m_expP, 2), "exponent p");
+    check(BN_add_word(m_expQ, 1) && BN_rshift(m_expQ, m_expQ, 2), "exponent q");
+
+    check(BN_MONT_CTX_set(m_montP, m_p, ctx), "BN_MONT_CTX_set p");
+    check(BN_MONT_CTX_set(m_montQ, m_q, ctx), "BN_MONT_CTX_set q");
+    check(BN_MONT_CTX_set(m_montN, m_n, ctx), "BN_MONT_CTX_set n");
+
+    {
+      ContextFrame frame(ctx);
+      BIGNUM* qInv = frame.get();
+      check(BN_mod_inverse(qInv, m_q, m_p, ctx) != nullptr, "BN_mod_inverse");
+      check(BN_to_montgomery(m_qInvR, qInv, m_montP, ctx), "BN_to_montgomery");
+    }
+
+    /* private exponentiations must not leak timing */
+    BN_set_flags(m_p, BN_FLG_CONSTTIME);
+    BN_set_flags(m_q, BN_FLG_CONSTTIME);
+    BN_set_flags(m_expP, BN_FLG_CONSTTIME);
+    BN_set_flags(m_expQ, BN_FLG_CONSTTIME);
+
+    m_bits = BN_num_bits(m_n);
+    m_blockSize = (size_t) BN_num_bytes(m_n);
+
+  } catch (...) {
+    release();
+    throw;
+  }
+
+}
+
+BigRabinKey::~BigRabinKey() {
+  release();
+}
+
+void BigRabinKey::release() {
+  BN_clear_free(m_p);
+  BN_clear_free(m_q);
+  BN_free(m_n);
+  BN_clear_free(m_expP);
+  BN_clear_free(m_expQ);
+  BN_clear_free(m_qInvR);
+  BN_MONT_CTX_free(m_montP);
+  BN_MONT_CTX_free(m_montQ);
+  BN_MONT_CTX_free(m_montN);
+}
+
+void BigRabinKey::crt(const BIGNUM* mp, const BIGNUM* mq, BIGNUM* result, BN_CTX* ctx) const {
+  ContextFrame frame(ctx);
+  BIGNUM* h = frame.get();
+  check(BN_mod_sub(h, mp, mq, m_p, ctx), "BN_mod_sub");
+  check(BN_mod_mul_montgomery(h, h, m_qInvR, m_montP, ctx), "BN_mod_mul_montgomery"); // (mp - mq) * q^-1 (mod p)
+  check(BN_mul(result, h, m_q, ctx), "BN_mul");
+  check(BN_add(result, result, mq), "BN_add");
+}
+
+const BIGNUM* BigRabinKey::getN() const {
+  return m_n;
+}
+
+void BigRabinKey::encrypt(const BIGNUM* m, BIGNUM* c, BN_CTX* ctx) const {
+  ContextFrame frame(ctx);
+  BIGNUM* t = frame.get();
+  check(BN_mod_mul_montgomery(t, m, m, m_montN, ctx), "BN_mod_mul_montgomery"); // m^2 * R^-1
+  check(BN_to_montgomery(c, t, m_montN, ctx), "BN_to_montgomery");              // m^2
+}
+
+void BigRabinKey::roots(const BIGNUM* c, BIGNUM* roots[4], BN_CTX* ctx) const {
+
+  ContextFrame frame(ctx);
+  BIGNUM* mp = frame.get();
+  BIGNUM* mq = frame.get();
+
+  check(BN_mod_exp_mont(mp, c, m_expP, m_p, ctx, m_montP), "BN_mod_exp_mont p");
+  check(BN_mod_exp_mont(mq, c, m_expQ, m_q, ctx, m_montQ), "BN_mod_exp_mont q");
+
+  crt(mp, mq, roots[0], ctx);
+  if(!BN_is_zero(mq)) {
+    check(BN_sub(mq, m_q, mq), "BN_sub");
+  }
+  crt(mp, mq, roots[2], ctx);
+
+  for(int i = 0; i < 4; i += 2) {
+    if(BN_is_zero(roots[i])) {
+      BN_zero(roots[i + 1]);
+    } else {
+      check(BN_sub(roots[i + 1], m_n, roots[i]), "BN_sub");
+    }
+  }
+
+}
+
+void BigRabinKey::decrypt(const BIGNUM* c, int jacobi, BIGNUM* m, BN_CTX* ctx) const {
+
+  ContextFrame frame(ctx);
+  BIGNUM* mp = frame.get();
+  BIGNUM* mq = frame.get();
+  BIGNUM* other = frame.get();
+
+  check(BN_mod_exp_mont(mp, c, m_expP, m_p, ctx, m_montP), "BN_mod_exp_mont p");
+  check(BN_mod_exp_mont(mq, c, m_expQ, m_q, ctx, m_montQ), "BN_mod_exp_mont q");
+
+  /* principal roots have Legendre symbol 1, negating the root modulo q flips the Jacobi symbol */
+  if(jacobi < 0 && !BN_is_zero(mq)) {
+    check(BN_sub(mq, m_q, mq), "BN_sub");
+  }
+  crt(mp, mq, m, ctx);
+
+  check(BN_sub(other, m_n, m), "BN_sub");
+  if(BN_cmp(other, m) < 0) {
+    check(BN_copy(m, other) != nullptr, "BN_copy");
+  }
+
+}
+
+int BigRabinKey::getModulusBits() const {
+  return m_bits;
+}
+
+size_t BigRabinKey::getBlockSize() const {
+  return m_blockSize;
+}
+
+void BigRabinKey::modulusBlock(uint8_t* n) const {
+  check(BN_bn2binpad(m_n, n, (int) m_blockSize) >= 0, "BN_bn2binpad");
+}
+
+void BigRabinKey::encryptBlock(const uint8_t* m, uint8_t* c) const {
+  BN_CTX* ctx = getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* value = frame.get();
+  check(BN_bin2bn(m, (int) m_blockSize, value) != nullptr, "BN_bin2bn");
+  encrypt(value, value, ctx);
+  check(BN_bn2binpad(value, c, (int) m_blockSize) >= 0, "BN_bn2binpad");
+}
+
+void BigRabinKey::rootsBlock(const uint8_t* c, uint8_t* roots) const {
+  BN_CTX* ctx = getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* value = frame.get();
+  BIGNUM* r[4];
+  for(int i = 0; i < 4; i ++) {
+    r[i] = frame.get();
+  }
+  check(BN_bin2bn(c, (int) m_blockSize, value) != nullptr, "BN_bin2bn");
+  this->roots(value, r, ctx);
+  for(int i = 0; i < 4; i ++) {
+    check(BN_bn2binpad(r[i], roots + i * m_blockSize, (int) m_blockSize) >= 0, "BN_bn2binpad");
+  }
+}
+
+int BigRabinKey::jacobiBlock(const uint8_t* m) const {
+  BN_CTX* ctx = getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* value = frame.get();
+  check(BN_bin2bn(m, (int) m_blockSize, value) != nullptr, "BN_bin2bn");
+  int result = BN_kronecker(value, m_n, ctx);
+  check(result != -2, "BN_kronecker");
+  return result;
+}
+
+void BigRabinKey::decryptBlock(const uint8_t* c, int jacobi, uint8_t* m) const {
+  BN_CTX* ctx = getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* value = frame.get();
+  check(BN_bin2bn(c, (int) m_blockSize, value) != nullptr, "BN_bin2bn");
+  decrypt(value, jacobi, value, ctx);
+  check(BN_bn2binpad(value, m, (int) m_blockSize) >= 0, "BN_bn2binpad");
+}
@@ -0,0 +1,124 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef BigRabinKey_hpp
+#define BigRabinKey_hpp
+
+#include "./RabinBackend.hpp"
+
+#include <openssl/bn.h>
+
+/**
+ * Multi-precision Rabin private key (2048/3072-bit moduli) on top of OpenSSL BIGNUM. <br>
+ * Montgomery contexts for `p`, `q` and `n`, square-root exponents and the CRT coefficient
+ * are computed once in the constructor. Decryption costs two half-size modexps plus a Garner CRT step.
+ * Scratch `BN_CTX` is kept per thread and reused across calls.
+ */
+class BigRabinKey : public RabinBackend {
+private:
+  BIGNUM* m_p; // larger prime
+  BIGNUM* m_q; // smaller prime
+  BIGNUM* m_n;
+  BIGNUM* m_expP;  // (p + 1) / 4
+  BIGNUM* m_expQ;  // (q + 1) / 4
+  BIGNUM* m_qInvR; // q^-1 * R (mod p) - Montgomery form
+  BN_MONT_CTX* m_montP;
+  BN_MONT_CTX* m_montQ;
+  BN_MONT_CTX* m_montN;
+  int m_bits;
+  size_t m_blockSize;
+private:
+  void release();
+  void crt(const BIGNUM* mp, const BIGNUM* mq, BIGNUM* result, BN_CTX* ctx) const;
+public:
+
+  /**
+   * Scratch `BN_CTX` of the calling thread. Created on first use, freed on thread exit.
+   * @return
+   */
+  static BN_CTX* getThreadContext();
+
+public:
+
+  /**
+   * Constructor. Primes are copied.
+   * @param p - prime, `p = 3 (mod 4)`.
+   * @param q - prime, `q = 3 (mod 4)`, `q != p`.
+   */
+  BigRabinKey(const BIGNUM* p, const BIGNUM* q);
+
+  BigRabinKey(const BigRabinKey&) = delete;
+  BigRabinKey& operator=(const BigRabinKey&) = delete;
+
+  /**
+   * Destructor.
+   */
+  ~BigRabinKey();
+
+  /**
+   * Public modulus `n = p * q`.
+   * @return
+   */
+  const BIGNUM* getN() const;
+
+  /**
+   * `c = m^2 (mod n)`.
+   * @param m - plaintext, `m < n`.
+   * @param c - output.
+   * @param ctx - scratch context.
+   */
+  void encrypt(const BIGNUM* m, BIGNUM* c, BN_CTX* ctx) const;
+
+  /**
+   * All four square roots of `c` modulo `n`.
+   * @param c - ciphertext.
+   * @param roots - four output numbers. `roots[0..1]` and `roots[2..3]` are `{r, n - r}` pairs.
+   * @param ctx - scratch context.
+   */
+  void roots(const BIGNUM* c, BIGNUM* roots[4], BN_CTX* ctx) const;
+
+  /**
+   * The square root of `c` which has Jacobi symbol `jacobi` and is below `n / 2`.
+   * @param c - ciphertext.
+   * @param jacobi - Jacobi symbol of the plaintext, `0` is treated as `1`.
+   * @param m - output.
+   * @param ctx - scratch context.
+   */
+  void decrypt(const BIGNUM* c, int jacobi, BIGNUM* m, BN_CTX* ctx) const;
+
+public: // RabinBackend
+
+  int getModulusBits() const override;
+  size_t getBlockSize() const override;
+  void modulusBlock(uint8_t* n) const override;
+  void encryptBlock(const uint8_t* m, uint8_t* c) const override;
+  void rootsBlock(const uint8_t* c, uint8_t* roots) const override;
+  int jacobiBlock(const uint8_t* m) const override;
+  void decryptBlock(const uint8_t* c, int jacobi, uint8_t* m) const override;
+
+};
+
+#endif // BigRabinKey_hpp
@@ -0,0 +1,333 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef FixedRabinKey_hpp
+#define FixedRabinKey_hpp
+
+#include "./RabinKey.hpp"
+
+/**
+ * `constexpr` modular arithmetic on `uint64_t` for compile-time key setup. <br>
+ * C++11 `constexpr` - single-expression recursive functions.
+ */
+struct RabinConstexpr {
+
+  typedef RabinWordTraits<uint64_t>::DWord DWord;
+
+  static constexpr uint64_t mulMod(uint64_t a, uint64_t b, uint64_t mod) {
+    return (uint64_t) (DWord(a) * b % mod);
+  }
+
+  static constexpr uint64_t powMod(uint64_t base, uint64_t exp, uint64_t mod) {
+    return exp == 0 ? 1 % mod : mulMod(exp & 1 ? base : 1, powMod(mulMod(base, base, mod), exp >> 1, mod), mod);
+  }
+
+  /**
+   * `mod^-1 (mod 2^64)` - Newton iterations from `inv = mod`, which is correct to 3 bits.
+   */
+  static constexpr uint64_t inverse2k(uint64_t mod, uint64_t inv = 0, int steps = 5) {
+    return inv == 0 ? inverse2k(mod, mod, steps) : steps == 0 ? inv : inverse2k(mod, inv * (2 - mod * inv), steps - 1);
+  }
+
+  /**
+   * Index of the highest set bit, `0` for `0` and `1`.
+   */
+  static constexpr int topBit(uint64_t x) {
+    return x <= 1 ? 0 : 1 + topBit(x >> 1);
+  }
+
+  static constexpr int trailingZeros(uint64_t x) {
+    return (x & 1) ? 0 : 1 + trailingZeros(x >> 1);
+  }
+
+  /*
+   * One of x, x^2, ..., x^(2^(count - 1)) is n - 1.
+   */
+  static constexpr bool reachesMinusOne(uint64_t x, int count, uint64_t n) {
+    return count == 0 ? false : x == n - 1 ? true : reachesMinusOne(mulMod(x, x, n), count - 1, n);
+  }
+
+  static constexpr bool millerRabinRound(uint64_t n, uint64_t a, uint64_t d, int s) {
+    return a % n == 0 || powMod(a, d, n) == 1 || reachesMinusOne(powMod(a, d, n), s, n);
+  }
+
+  static constexpr bool millerRabin(uint64_t n, uint64_t d, int s) {
+    return millerRabinRound(n, 2, d, s) && millerRabinRound(n, 3, d, s) && millerRabinRound(n, 5, d, s)
+        && millerRabinRound(n, 7, d, s) && millerRabinRound(n, 11, d, s) && millerRabinRound(n, 13, d, s)
+        && millerRabinRound(n, 17, d, s) && millerRabinRound(n, 19, d, s) && millerRabinRound(n, 23, d, s)
+        && millerRabinRound(n, 29, d, s) && millerRabinRound(n, 31, d, s) && millerRabinRound(n, 37, d, s);
+  }
+
+  /**
+   * Deterministic Miller-Rabin primality test - bases up to 37 cover all 64-bit numbers.
+   */
+  static constexpr bool isPrime(uint64_t n) {
+    return n < 2 ? false : n < 4 ? true : (n & 1) == 0 ? false
+         : millerRabin(n, (n - 1) >> trailingZeros(n - 1), trailingZeros(n - 1));
+  }
+
+};
+
+/**
+ * Montgomery arithmetic modulo `MOD` with all reduction constants computed at compile time.
+ * Same operations as `RabinMontgomery<uint64_t>`.
+ * @tparam MOD - odd modulus below `2^63`.
+ */
+template<uint64_t MOD>
+struct FixedRabinMontgomery {
+
+  static_assert((MOD & 1) == 1 && (MOD >> 63) == 0, "Modulus must be odd and below 2^63.");
+
+  typedef RabinConstexpr::DWord DWord;
+
+  static constexpr uint64_t NEG_INV = 0 - RabinConstexpr::inverse2k(MOD); // -MOD^-1 (mod R)
+  static constexpr uint64_t R1 = (0 - MOD) % MOD;                         // R   (mod MOD)
+  static constexpr uint64_t R2 = (uint64_t) (DWord(R1) * R1 % MOD);       // R^2 (mod MOD)
+  static constexpr uint64_t R3 = (uint64_t) (DWord(R2) * R1 % MOD);       // R^3 (mod MOD)
+
+  static uint64_t reduce(DWord t) {
+    uint64_t m = uint64_t(t) * NEG_INV;
+    uint64_t u = uint64_t((t + DWord(m) * MOD) >> 64);
+    return u >= MOD ? u - MOD : u;
+  }
+
+  static uint64_t mul(uint64_t a, uint64_t b) {
+    return reduce(DWord(a) * b);
+  }
+
+  static uint64_t toMont(uint64_t a) {
+    return mul(a, R2);
+  }
+
+  static uint64_t reduceToMont(DWord a) {
+    return mul(reduce(a), R3);
+  }
+
+  static uint64_t fromMont(uint64_t aMont) {
+    return reduce(aMont);
+  }
+
+  static uint64_t squareMod(uint64_t a) {
+    return mul(reduce(DWord(a) * a), R2);
+  }
+
+  /**
+   * `base^EXP` in Montgomery form. The square-and-multiply chain is unrolled at compile time -
+   * no loop and no branches on exponent bits.
+   */
+  template<uint64_t EXP>
+  static uint64_t powMont(uint64_t baseMont);
+
+};
+
+template<uint64_t MOD> constexpr uint64_t FixedRabinMontgomery<MOD>::NEG_INV;
+template<uint64_t MOD> constexpr uint64_t FixedRabinMontgomery<MOD>::R1;
+template<uint64_t MOD> constexpr uint64_t FixedRabinMontgomery<MOD>::R2;
+template<uint64_t MOD> constexpr uint64_t FixedRabinMontgomery<MOD>::R3;
+
+/*
+ * Left-to-right square-and-multiply over bits BIT..0 of EXP.
+ */
+template<uint64_t MOD, uint64_t EXP, int BIT>
+struct FixedRabinPow {
+  static uint64_t apply(uint64_t baseMont, uint64_t acc) {
+    typedef FixedRabinMontgomery<MOD> Mont;
+    acc = Mont::mul(acc, acc);
+    if((EXP >> BIT) & 1) {
+      acc = Mont::mul(acc, baseMont);
+    }
+    return FixedRabinPow<MOD, EXP, BIT - 1>::apply(baseMont, acc);
+  }
+};
+
+template<uint64_t MOD, uint64_t EXP>
+struct FixedRabinPow<MOD, EXP, -1> {
+  static uint64_t apply(uint64_t, uint64_t acc) {
+    return acc;
+  }
+};
+
+template<uint64_t MOD>
+template<uint64_t EXP>
+uint64_t FixedRabinMontgomery<MOD>::powMont(uint64_t baseMont) {
+  // the top bit is always set - start from the base instead of squaring one
+  return EXP == 0 ? R1 : FixedRabinPow<MOD, EXP, RabinConstexpr::topBit(EXP) - 1>::apply(baseMont, baseMont);
+}
+
+/**
+ * Rabin private key fixed at compile time. <br>
+ * Modulus, CRT coefficient, square-root exponents and Montgomery constants are `constexpr`,
+ * and the fixed-exponent square roots are fully unrolled. Primes are validated by `static_assert`. <br>
+ * Same interface as `RabinKey` - works with `SmallRabinBackend` and `RabinCryptosystem`:
+ * ```
+ * typedef FixedRabinKey<2147483647, 2147483587> DemoKey;
+ * auto backend = std::make_shared<SmallRabinBackend<DemoKey>>(std::make_shared<DemoKey>());
+ * ```
+ * @tparam P - prime, `P = 3 (mod 4)`.
+ * @tparam Q - prime, `Q = 3 (mod 4)`, `Q != P`.
+ */
+template<uint64_t P, uint64_t Q>
+class FixedRabinKey {
+public:
+  typedef uint64_t WordType;
+  typedef RabinConstexpr::DWord DWord;
+public:
+
+  static constexpr uint64_t PRIME_P = P > Q ? P : Q; // larger prime
+  static constexpr uint64_t PRIME_Q = P > Q ? Q : P; // smaller prime
+
+  static_assert(P % 4 == 3 && Q % 4 == 3 && P != Q, "Primes must be distinct and = 3 (mod 4).");
+  static_assert(RabinConstexpr::isPrime(P) && RabinConstexpr::isPrime(Q), "P and Q must be prime.");
+  static_assert(DWord(PRIME_P) * PRIME_Q < (DWord(1) << 63), "Modulus must be below 2^63.");
+
+  static constexpr uint64_t MODULUS = PRIME_P * PRIME_Q;
+  static constexpr uint64_t EXP_P = (PRIME_P + 1) / 4;
+  static constexpr uint64_t EXP_Q = (PRIME_Q + 1) / 4;
+  static constexpr uint64_t Q_INV = RabinConstexpr::powMod(PRIME_Q, PRIME_P - 2, PRIME_P); // q^-1 (mod p)
+  static constexpr uint32_t BATCH_N = MODULUS > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (uint32_t) MODULUS;
+  static constexpr uint32_t BATCH_MU = RabinBatch::getBarrettConstant(MODULUS);
+
+  static constexpr size_t DECRYPT_MIN_PER_THREAD = RabinKey::DECRYPT_MIN_PER_THREAD;
+
+private:
+  typedef FixedRabinMontgomery<PRIME_P> MontP;
+  typedef FixedRabinMontgomery<PRIME_Q> MontQ;
+  typedef FixedRabinMontgomery<MODULUS> MontN;
+private:
+
+  static uint64_t crt(uint64_t mpMont, uint64_t mq) {
+    uint64_t mqMont = MontP::toMont(mq);
+    uint64_t diff = mpMont >= mqMont ? mpMont - mqMont : mpMont + PRIME_P - mqMont;
+    uint64_t h = MontP::mul(diff, Q_INV);
+    return mq + PRIME_Q * h;
+  }
+
+  static void halfRoots(uint64_t c, uint64_t& mpMont, uint64_t& mq) {
+    mpMont = MontP::template powMont<EXP_P>(MontP::reduceToMont(c));
+    mq = MontQ::fromMont(MontQ::template powMont<EXP_Q>(MontQ::reduceToMont(c)));
+  }
+
+public:
+
+  uint64_t getP() const {
+    return PRIME_P;
+  }
+
+  uint64_t getQ() const {
+    return PRIME_Q;
+  }
+
+  uint64_t getN() const {
+    return MODULUS;
+  }
+
+  /**
+   * See `BasicRabinKey::encrypt()`.
+   */
+  uint64_t encrypt(uint64_t m) const {
+    return MontN::squareMod(m);
+  }
+
+  /**
+   * See `BasicRabinKey::encryptBatch()`.
+   */
+  void encryptBatch(const uint8_t* in, size_t count, uint32_t* out) const {
+    RabinBatch::encryptBytes(in, count, BATCH_N, BATCH_MU, out);
+  }
+
+  /**
+   * See `BasicRabinKey::roots()`.
+   */
+  void roots(uint64_t c, uint64_t roots[4]) const {
+    uint64_t mpMont, mq;
+    halfRoots(c, mpMont, mq);
+    uint64_t x = crt(mpMont, mq);
+    uint64_t y = crt(mpMont, mq == 0 ? 0 : PRIME_Q - mq);
+    roots[0] = x;
+    roots[1] = x == 0 ? 0 : MODULUS - x;
+    roots[2] = y;
+    roots[3] = y == 0 ? 0 : MODULUS - y;
+  }
+
+  /**
+   * See `BasicRabinKey::jacobi()`.
+   */
+  int jacobi(uint64_t m) const {
+    return RabinKey::jacobiSymbol(m, MODULUS);
+  }
+
+  /**
+   * See `BasicRabinKey::decryptBlock()`.
+   */
+  uint64_t decryptBlock(uint64_t c, int jacobi) const {
+    uint64_t mpMont, mq;
+    halfRoots(c, mpMont, mq);
+    if(jacobi < 0 && mq != 0) {
+      mq = PRIME_Q - mq;
+    }
+    uint64_t x = crt(mpMont, mq);
+    uint64_t y = MODULUS - x;
+    return x < y ? x : y;
+  }
+
+  /**
+   * See `BasicRabinKey::decryptBatch()`. The unrolled chains need no tiling - each thread runs a plain loop.
+   */
+  void decryptBatch(const uint64_t* c, const int8_t* jacobi, size_t count, uint64_t* out, unsigned threads = 0) const {
+    RabinBatch::forEachShare(count, threads, DECRYPT_MIN_PER_THREAD, [this, c, jacobi, out](size_t start, size_t size) {
+      for(size_t i = start; i < start + size; i ++) {
+        out[i] = decryptBlock(c[i], jacobi[i]);
+      }
+    });
+  }
+
+  /**
+   * See `BasicRabinKey::decrypt()`.
+   */
+  int decrypt(uint64_t c) const {
+    uint64_t r[4];
+    roots(c, r);
+    for(int i = 0; i < 4; i ++) {
+      if(r[i] < 128) {
+        return (int) r[i];
+      }
+    }
+    return -1;
+  }
+
+};
+
+template<uint64_t P, uint64_t Q> constexpr uint64_t FixedRabinKey<P, Q>::PRIME_P;
+template<uint64_t P, uint64_t Q> constexpr uint64_t FixedRabinKey<P, Q>::PRIME_Q;
+template<uint64_t P, uint64_t Q> constexpr uint64_t FixedRabinKey<P, Q>::MODULUS;
+template<uint64_t P, uint64_t Q> constexpr uint64_t FixedRabinKey<P, Q>::EXP_P;
+template<uint64_t P, uint64_t Q> constexpr uint64_t FixedRabinKey<P, Q>::EXP_Q;
+template<uint64_t P, uint64_t Q> constexpr uint64_t FixedRabinKey<P, Q>::Q_INV;
+template<uint64_t P, uint64_t Q> constexpr uint32_t FixedRabinKey<P, Q>::BATCH_N;
+template<uint64_t P, uint64_t Q> constexpr uint32_t FixedRabinKey<P, Q>::BATCH_MU;
+template<uint64_t P, uint64_t Q> constexpr size_t FixedRabinKey<P, Q>::DECRYPT_MIN_PER_THREAD;
+
+#endif // FixedRabinKey_hpp
@@ -0,0 +1,179 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinBackend_hpp
+#define RabinBackend_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Key-size independent view of a Rabin private key. <br>
+ * Numbers are exchanged as big-endian, zero-padded blocks of exactly `getBlockSize()` bytes.
+ * Implementations must be immutable and safe to use from several threads at once.
+ */
+class RabinBackend {
+public:
+
+  /**
+   * Default virtual destructor.
+   */
+  virtual ~RabinBackend() = default;
+
+  /**
+   * Bit length of the modulus `n`.
+   * @return
+   */
+  virtual int getModulusBits() const = 0;
+
+  /**
+   * Size of one block in bytes - `ceil(getModulusBits() / 8)`.
+   * @return
+   */
+  virtual size_t getBlockSize() const = 0;
+
+  /**
+   * Public modulus `n`.
+   * @param n - output block.
+   */
+  virtual void modulusBlock(uint8_t* n) const = 0;
+
+  /**
+   * `c = m^2 (mod n)`.
+   * @param m - plaintext block, `m < n`.
+   * @param c - output ciphertext block.
+   */
+  virtual void encryptBlock(const uint8_t* m, uint8_t* c) const = 0;
+
+  /**
+   * All four square roots of `c` modulo `n`.
+   * @param c - ciphertext block.
+   * @param roots - output, `4 * getBlockSize()` bytes - four consecutive blocks.
+   */
+  virtual void rootsBlock(const uint8_t* c, uint8_t* roots) const = 0;
+
+  /**
+   * Jacobi symbol `(m / n)`.
+   * @param m - plaintext block, `m < n`.
+   * @return - `-1`, `0` or `1`.
+   */
+  virtual int jacobiBlock(const uint8_t* m) const = 0;
+
+  /**
+   * The square root of `c` which has Jacobi symbol `jacobi` and is below `n / 2`.
+   * @param c - ciphertext block.
+   * @param jacobi - Jacobi symbol of the plaintext, `0` is treated as `1`.
+   * @param m - output plaintext block.
+   */
+  virtual void decryptBlock(const uint8_t* c, int jacobi, uint8_t* m) const = 0;
+
+};
+
+/**
+ * `RabinBackend` over a machine-word key (`BasicRabinKey`).
+ * @tparam Key - key type with `WordType`, `getN()`, `encrypt()` and `roots()`.
+ */
+template<class Key>
+class SmallRabinBackend : public RabinBackend {
+public:
+  typedef typename Key::WordType Word;
+private:
+  std::shared_ptr<const Key> m_key;
+  int m_bits;
+  size_t m_blockSize;
+private:
+
+  Word readWord(const uint8_t* data) const {
+    Word result = 0;
+    for(size_t i = 0; i < m_blockSize; i ++) {
+      result = (result << 8) | data[i];
+    }
+    return result;
+  }
+
+  void writeWord(Word value, uint8_t* data) const {
+    for(size_t i = m_blockSize; i > 0; i --) {
+      data[i - 1] = (uint8_t) value;
+      value >>= 8;
+    }
+  }
+
+public:
+
+  SmallRabinBackend(const std::shared_ptr<const Key>& key)
+    : m_key(key)
+    , m_bits(0)
+  {
+    for(Word n = key->getN(); n > 0; n >>= 1) {
+      ++ m_bits;
+    }
+    m_blockSize = (m_bits + 7) / 8;
+  }
+
+  /**
+   * Underlying machine-word key - use it directly on hot paths.
+   * @return
+   */
+  const std::shared_ptr<const Key>& getKey() const {
+    return m_key;
+  }
+
+  int getModulusBits() const override {
+    return m_bits;
+  }
+
+  size_t getBlockSize() const override {
+    return m_blockSize;
+  }
+
+  void modulusBlock(uint8_t* n) const override {
+    writeWord(m_key->getN(), n);
+  }
+
+  void encryptBlock(const uint8_t* m, uint8_t* c) const override {
+    writeWord(m_key->encrypt(readWord(m)), c);
+  }
+
+  void rootsBlock(const uint8_t* c, uint8_t* roots) const override {
+    Word r[4];
+    m_key->roots(readWord(c), r);
+    for(int i = 0; i < 4; i ++) {
+      writeWord(r[i], roots + i * m_blockSize);
+    }
+  }
+
+  int jacobiBlock(const uint8_t* m) const override {
+    return m_key->jacobi(readWord(m));
+  }
+
+  void decryptBlock(const uint8_t* c, int jacobi, uint8_t* m) const override {
+    writeWord(m_key->decryptBlock(readWord(c), jacobi), m);
+  }
+
+};
+
+#endif // RabinBackend_hpp
@@ -0,0 +1,118 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "RabinBatch.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define RABIN_BATCH_AVX2
+  #include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*EncryptBytesFunction)(const uint8_t* in, size_t count, uint32_t n, uint32_t mu, uint32_t* out);
+
+inline uint32_t barrettSquare(uint32_t m, uint32_t n, uint32_t mu) {
+  uint32_t x = m * m;
+  uint32_t q = (uint32_t) (((uint64_t) x * mu) >> 32);
+  uint32_t r = x - q * n;
+  return r >= n ? r - n : r;
+}
+
+#ifdef RABIN_BATCH_AVX2
+
+__attribute__((target("avx2")))
+inline __m256i barrettSquare8(__m128i bytes, __m256i n, __m256i mu) {
+
+  __m256i x = _mm256_cvtepu8_epi32(bytes);
+  x = _mm256_mullo_epi32(x, x);
+
+  /* q = (x * mu) >> 32 - 64-bit products of even and odd lanes */
+  __m256i even = _mm256_mul_epu32(x, mu);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), mu);
+  __m256i q = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+
+  __m256i r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, n));
+
+  /* r >= n (unsigned) -> r - n */
+  __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(r, n), r);
+  return _mm256_sub_epi32(r, _mm256_and_si256(ge, n));
+
+}
+
+__attribute__((target("avx2")))
+void encryptBytesAvx2(const uint8_t* in, size_t count, uint32_t n, uint32_t mu, uint32_t* out) {
+
+  __m256i vn = _mm256_set1_epi32((int) n);
+  __m256i vmu = _mm256_set1_epi32((int) mu);
+
+  size_t i = 0;
+  for(; i + 16 <= count; i += 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*) (in + i));
+    __m256i lo = barrettSquare8(bytes, vn, vmu);
+    __m256i hi = barrettSquare8(_mm_srli_si128(bytes, 8), vn, vmu);
+    _mm256_storeu_si256((__m256i*) (out + i), lo);
+    _mm256_storeu_si256((__m256i*) (out + i + 8), hi);
+  }
+
+  for(; i < count; i ++) {
+    out[i] = barrettSquare(in[i], n, mu);
+  }
+
+}
+
+#endif
+
+EncryptBytesFunction selectEncryptBytes() {
+#ifdef RABIN_BATCH_AVX2
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) {
+    return &encryptBytesAvx2;
+  }
+#endif
+  return &RabinBatch::encryptBytesScalar;
+}
+
+EncryptBytesFunction getEncryptBytes() {
+  static const EncryptBytesFunction function = selectEncryptBytes();
+  return function;
+}
+
+}
+
+bool RabinBatch::isAvx2Enabled() {
+  return getEncryptBytes() != &RabinBatch::encryptBytesScalar;
+}
+
+void RabinBatch::encryptBytes(const uint8_t* in, size_t count, uint32_t n, uint32_t mu, uint32_t* out) {
+  getEncryptBytes()(in, count, n, mu, out);
+}
+
+void RabinBatch::encryptBytesScalar(const uint8_t* in, size_t count, uint32_t n, uint32_t mu, uint32_t* out) {
+  for(size_t i = 0; i < count; i ++) {
+    out[i] = barrettSquare(in[i], n, mu);
+  }
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinBatch_hpp
+#define RabinBatch_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/**
+ * Bulk byte-wise Rabin encryption `out[i] = in[i]^2 (mod n)` for small moduli. <br>
+ * Reduction is Barrett with `mu = floor(2^32 / n)`. On x86 CPUs with AVX2 (detected at runtime)
+ * 16 bytes are processed per iteration in two 8-lane vectors, otherwise a scalar loop is used.
+ */
+class RabinBatch {
+public:
+
+  /**
+   * Barrett constant for `n`.
+   * @param n - modulus.
+   * @return - `floor(2^32 / n)`, `0` if `n >= 2^32` - squares of bytes never need reduction then.
+   */
+  static constexpr uint32_t getBarrettConstant(uint64_t n) {
+    return n > 0xFFFFFFFFULL ? 0 : (uint32_t) ((1ULL << 32) / n);
+  }
+
+  /**
+   * Check if the AVX2 kernel is used on this CPU.
+   * @return
+   */
+  static bool isAvx2Enabled();
+
+  /**
+   * Encrypt `count` bytes.
+   * @param in - plaintext bytes.
+   * @param count - number of bytes.
+   * @param n - modulus. Values above `2^32 - 1` are passed as `0xFFFFFFFF`.
+   * @param mu - `getBarrettConstant(n)`.
+   * @param out - `count` ciphertexts.
+   */
+  static void encryptBytes(const uint8_t* in, size_t count, uint32_t n, uint32_t mu, uint32_t* out);
+
+  /**
+   * Portable implementation of `encryptBytes()`.
+   */
+  static void encryptBytesScalar(const uint8_t* in, size_t count, uint32_t n, uint32_t mu, uint32_t* out);
+
+  /**
+   * Split `[0, count)` into contiguous shares, one per thread, and call `func(start, size)` for each share.
+   * The first share runs on the calling thread. Returns when all shares are done.
+   * @param count - number of elements.
+   * @param threads - max number of threads, `0` - number of hardware threads.
+   * @param minShare - smallest share worth a separate thread.
+   * @param func - `void(size_t start, size_t size)`.
+   */
+  template<typename F>
+  static void forEachShare(size_t count, unsigned threads, size_t minShare, const F& func) {
+
+    if(threads == 0) {
+      threads = std::thread::hardware_concurrency();
+    }
+    size_t share = threads > 1 ? (count + threads - 1) / threads : count;
+    if(share < minShare) {
+      share = minShare;
+    }
+
+    if(count <= share) {
+      func(0, count);
+      return;
+    }
+
+    std::vector<std::thread> workers;
+    for(size_t start = share; start < count; start += share) {
+      size_t size = count - start < share ? count - start : share;
+      workers.emplace_back([&func, start, size] {
+        func(start, size);
+      });
+    }
+    func(0, share);
+    for(auto& worker : workers) {
+      worker.join();
+    }
+
+  }
+
+};
+
+#endif // RabinBatch_hpp
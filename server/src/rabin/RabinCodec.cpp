@@ -0,0 +1,330 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "RabinCodec.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+constexpr uint8_t RabinCodec::VERSION;
+constexpr size_t RabinCodec::HEADER_SIZE;
+constexpr size_t RabinCodec::REDUNDANCY_SIZE;
+
+size_t RabinCodec::computePayloadSize(int bits) {
+  size_t blockBytes = bits >= 10 ? (size_t) (bits - 2) / 8 : 1;
+  size_t redundancy = blockBytes - 1 < REDUNDANCY_SIZE ? blockBytes - 1 : REDUNDANCY_SIZE;
+  return blockBytes - redundancy;
+}
+
+RabinCodec::RabinCodec(const std::shared_ptr<const RabinBackend>& backend)
+  : m_backend(backend)
+  , m_bits(backend->getModulusBits())
+  , m_blockSize(backend->getBlockSize())
+  , m_payloadSize(computePayloadSize(m_bits))
+  , m_wireBlockSize((size_t) m_bits / 8 + 1)
+{
+  if(m_bits < 10 || m_bits > 0xFFFF) {
+    throw std::runtime_error("[RabinCodec::RabinCodec()]: Error. Unsupported modulus size.");
+  }
+}
+
+const std::shared_ptr<const RabinBackend>& RabinCodec::getBackend() const {
+  return m_backend;
+}
+
+size_t RabinCodec::getPayloadSize() const {
+  return m_payloadSize;
+}
+
+size_t RabinCodec::getWireBlockSize() const {
+  return m_wireBlockSize;
+}
+
+size_t RabinCodec::getEncodedSize(size_t plaintextSize) const {
+  return HEADER_SIZE + (plaintextSize + m_payloadSize - 1) / m_payloadSize * m_wireBlockSize;
+}
+
+void RabinCodec::writeHeader(uint64_t plaintextSize, uint8_t* out) const {
+  out[0] = 'R';
+  out[1] = 'B';
+  out[2] = VERSION;
+  out[3] = (uint8_t) (m_bits >> 8);
+  out[4] = (uint8_t) m_bits;
+  uint64_t size = plaintextSize;
+  for(int i = 12; i >= 5; i --) {
+    out[i] = (uint8_t) size;
+    size >>= 8;
+  }
+}
+
+void RabinCodec::encryptBlock(const uint8_t* payload, size_t size, uint8_t* m, uint8_t* out) const {
+
+  /* payload occupies the low bytes of the block, the rest (redundancy) is zero */
+  std::memset(m, 0, m_blockSize);
+  std::memcpy(m + m_blockSize - m_payloadSize, payload, size);
+
+  int jacobi = m_backend->jacobiBlock(m);
+
+  uint8_t* c = out + m_wireBlockSize - m_blockSize;
+  out[0] = 0;
+  m_backend->encryptBlock(m, c);
+
+  if(jacobi < 0) {
+    out[m_wireBlockSize - 1 - m_bits / 8] |= (uint8_t) (1 << (m_bits % 8));
+  }
+
+}
+
+void RabinCodec::decryptBlock(const uint8_t* in, uint8_t* c, uint8_t* m) const {
+
+  std::memcpy(c, in + m_wireBlockSize - m_blockSize, m_blockSize);
+
+  size_t hintByte = m_wireBlockSize - 1 - m_bits / 8;
+  uint8_t hintMask = (uint8_t) (1 << (m_bits % 8));
+  int jacobi = (in[hintByte] & hintMask) ? -1 : 1;
+  if(m_wireBlockSize == m_blockSize) {
+    c[hintByte] &= (uint8_t) ~hintMask;
+  }
+
+  m_backend->decryptBlock(c, jacobi, m);
+
+  /* redundancy: at least REDUNDANCY_SIZE zero bytes above the payload (see class doc for small keys).
+   * A wrong root is uniformly spread and fails here - returning it would leak the factorization of n. */
+  for(size_t i = 0; i < m_blockSize - m_payloadSize; i ++) {
+    if(m[i] != 0) {
+      throw std::runtime_error("[RabinCodec::decryptBlock()]: Error. Invalid block.");
+    }
+  }
+
+}
+
+std::string RabinCodec::encode(const char* data, size_t size) const {
+  std::string result(getEncodedSize(size), '\0');
+  Encoder encoder(*this, size);
+  encoder.write(data, size, (uint8_t*) &result[0]);
+  return result;
+}
+
+std::string RabinCodec::decode(const char* data, size_t size) const {
+  Decoder decoder(*this);
+  std::string result(decoder.getMaxOutputSize(size), '\0');
+  result.resize(decoder.write(data, size, (uint8_t*) &result[0]));
+  if(!decoder.isFinished()) {
+    throw std::runtime_error("[RabinCodec::decode()]: Error. Frame is truncated.");
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// RabinCodec::Encoder
+
+RabinCodec::Encoder::Encoder(const RabinCodec& codec, uint64_t plaintextSize)
+  : m_codec(&codec)
+  , m_scratch(codec.m_payloadSize + codec.m_blockSize)
+{
+  reset(plaintextSize);
+}
+
+void RabinCodec::Encoder::reset(uint64_t plaintextSize) {
+  m_totalSize = plaintextSize;
+  m_remaining = plaintextSize;
+  m_pendingSize = 0;
+  m_headerWritten = false;
+}
+
+size_t RabinCodec::Encoder::getMaxOutputSize(size_t size) const {
+  return (m_headerWritten ? 0 : HEADER_SIZE) + ((m_pendingSize + size) / m_codec->m_payloadSize + 1) * m_codec->m_wireBlockSize;
+}
+
+size_t RabinCodec::Encoder::write(const void* data, size_t size, uint8_t* out) {
+
+  if(size > m_remaining) {
+    throw std::runtime_error("[RabinCodec::Encoder::write()]: Error. Data exceeds declared plaintext size.");
+  }
+
+  const size_t payloadSize = m_codec->m_payloadSize;
+  const size_t wireBlockSize = m_codec->m_wireBlockSize;
+  uint8_t* pending = m_scratch.data();
+  uint8_t* m = pending + payloadSize;
+  uint8_t* start = out;
+
+  if(!m_headerWritten) {
+    m_codec->writeHeader(m_totalSize, out);
+    out += HEADER_SIZE;
+    m_headerWritten = true;
+  }
+
+  m_remaining -= size;
+  const uint8_t* in = (const uint8_t*) data;
+
+  while(size > 0) {
+
+    if(m_pendingSize == 0 && size >= payloadSize) {
+      m_codec->encryptBlock(in, payloadSize, m, out);
+      in += payloadSize;
+      size -= payloadSize;
+      out += wireBlockSize;
+      continue;
+    }
+
+    size_t chunk = payloadSize - m_pendingSize;
+    if(chunk > size) {
+      chunk = size;
+    }
+    std::memcpy(pending + m_pendingSize, in, chunk);
+    m_pendingSize += chunk;
+    in += chunk;
+    size -= chunk;
+
+    if(m_pendingSize == payloadSize) {
+      m_codec->encryptBlock(pending, payloadSize, m, out);
+      out += wireBlockSize;
+      m_pendingSize = 0;
+    }
+
+  }
+
+  if(m_remaining == 0 && m_pendingSize > 0) {
+    m_codec->encryptBlock(pending, m_pendingSize, m, out);
+    out += wireBlockSize;
+    m_pendingSize = 0;
+  }
+
+  return out - start;
+
+}
+
+bool RabinCodec::Encoder::isFinished() const {
+  return m_headerWritten && m_remaining == 0 && m_pendingSize == 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// RabinCodec::Decoder
+
+RabinCodec::Decoder::Decoder(const RabinCodec& codec)
+  : m_codec(&codec)
+  , m_scratch(codec.m_wireBlockSize + 2 * codec.m_blockSize)
+{
+  reset();
+}
+
+void RabinCodec::Decoder::reset() {
+  m_headerSize = 0;
+  m_blockFill = 0;
+  m_remaining = 0;
+}
+
+size_t RabinCodec::Decoder::getMaxOutputSize(size_t size) const {
+  return (m_blockFill + size) / m_codec->m_wireBlockSize * m_codec->m_payloadSize;
+}
+
+size_t RabinCodec::Decoder::write(const void* data, size_t size, uint8_t* out) {
+
+  const size_t payloadSize = m_codec->m_payloadSize;
+  const size_t wireBlockSize = m_codec->m_wireBlockSize;
+  const size_t blockSize = m_codec->m_blockSize;
+  uint8_t* block = m_scratch.data();
+  uint8_t* c = block + wireBlockSize;
+  uint8_t* m = c + blockSize;
+
+  const uint8_t* in = (const uint8_t*) data;
+  uint8_t* start = out;
+
+  if(m_headerSize < HEADER_SIZE) {
+
+    size_t chunk = HEADER_SIZE - m_headerSize;
+    if(chunk > size) {
+      chunk = size;
+    }
+    std::memcpy(m_header + m_headerSize, in, chunk);
+    m_headerSize += chunk;
+    in += chunk;
+    size -= chunk;
+
+    if(m_headerSize < HEADER_SIZE) {
+      return 0;
+    }
+
+    if(m_header[0] != 'R' || m_header[1] != 'B' || m_header[2] != VERSION) {
+      throw std::runtime_error("[RabinCodec::Decoder::write()]: Error. Invalid frame header.");
+    }
+    if(((m_header[3] << 8) | m_header[4]) != m_codec->m_bits) {
+      throw std::runtime_error("[RabinCodec::Decoder::write()]: Error. Frame was encrypted with a different key size.");
+    }
+    m_remaining = 0;
+    for(int i = 5; i <= 12; i ++) {
+      m_remaining = (m_remaining << 8) | m_header[i];
+    }
+
+  }
+
+  while(size > 0) {
+
+    if(m_remaining == 0) {
+      throw std::runtime_error("[RabinCodec::Decoder::write()]: Error. Data past the end of the frame.");
+    }
+
+    const uint8_t* wire;
+    if(m_blockFill == 0 && size >= wireBlockSize) {
+      wire = in;
+      in += wireBlockSize;
+      size -= wireBlockSize;
+    } else {
+      size_t chunk = wireBlockSize - m_blockFill;
+      if(chunk > size) {
+        chunk = size;
+      }
+      std::memcpy(block + m_blockFill, in, chunk);
+      m_blockFill += chunk;
+      in += chunk;
+      size -= chunk;
+      if(m_blockFill < wireBlockSize) {
+        break;
+      }
+      wire = block;
+      m_blockFill = 0;
+    }
+
+    m_codec->decryptBlock(wire, c, m);
+    size_t chunk = m_remaining < payloadSize ? (size_t) m_remaining : payloadSize;
+    for(size_t i = blockSize - payloadSize + chunk; i < blockSize; i ++) {
+      if(m[i] != 0) {
+        throw std::runtime_error("[RabinCodec::Decoder::write()]: Error. Invalid block padding.");
+      }
+    }
+    std::memcpy(out, m + blockSize - payloadSize, chunk);
+    out += chunk;
+    m_remaining -= chunk;
+
+  }
+
+  return out - start;
+
+}
+
+bool RabinCodec::Decoder::isFinished() const {
+  return m_headerSize == HEADER_SIZE && m_remaining == 0 && m_blockFill == 0;
+}
@@ -0,0 +1,225 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinCodec_hpp
+#define RabinCodec_hpp
+
+#include "./RabinBackend.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * Framed binary Rabin ciphertext format. <br>
+ * A block holds `(bits - 2) / 8` bytes, so every block is below `n / 2`: `REDUNDANCY_SIZE` zero bytes
+ * followed by the payload. Root selection needs the Jacobi symbol of the plaintext,
+ * which is stored in the spare top bit of the ciphertext. <br>
+ * The decrypted root is checked for redundancy: all bytes above the payload and the padding of the last block
+ * must be zero, otherwise the block is rejected. A wrong root (forged hint) passes with probability about `2^-64`,
+ * so decryption results never leak the other square root. Keys too small to fit the redundancy and one payload byte
+ * (under 82 bits) get less of it - they are for tests and benchmarks only. <br>
+ * Layout (all integers big-endian):
+ * <pre>
+ *   'R' 'B' version:u8 modulusBits:u16 plaintextSize:u64     - header, HEADER_SIZE bytes
+ *   block * ceil(plaintextSize / payloadSize)                 - each block is `getWireBlockSize()` bytes:
+ *                                                               `c | (jacobi == -1) << modulusBits`
+ * </pre>
+ */
+class RabinCodec {
+public:
+  static constexpr uint8_t VERSION = 2;
+  static constexpr size_t HEADER_SIZE = 13;
+  static constexpr size_t REDUNDANCY_SIZE = 8;
+public:
+
+  /**
+   * Incremental encoder. Plaintext may be fed in pieces of any size, memory use is one block. <br>
+   * Output goes straight into caller-provided buffers - no allocations after construction.
+   * Reusable with `reset()`. The codec must outlive the encoder.
+   */
+  class Encoder {
+  private:
+    const RabinCodec* m_codec;
+    std::vector<uint8_t> m_scratch; // [pending payload | m block]
+    uint64_t m_totalSize;
+    uint64_t m_remaining;
+    size_t m_pendingSize;
+    bool m_headerWritten;
+  public:
+
+    /**
+     * Constructor.
+     * @param codec
+     * @param plaintextSize - total size of the plaintext. Goes to the frame header.
+     */
+    Encoder(const RabinCodec& codec, uint64_t plaintextSize);
+
+    /**
+     * Start new frame.
+     * @param plaintextSize
+     */
+    void reset(uint64_t plaintextSize);
+
+    /**
+     * Upper bound of the output of `write(data, size, out)`.
+     * @param size
+     * @return
+     */
+    size_t getMaxOutputSize(size_t size) const;
+
+    /**
+     * Encrypt next piece of plaintext. The last block is flushed once all declared bytes are written.
+     * @param data
+     * @param size - total of all pieces must not exceed the declared plaintext size.
+     * @param out - at least `getMaxOutputSize(size)` bytes.
+     * @return - number of bytes written to `out`.
+     */
+    size_t write(const void* data, size_t size, uint8_t* out);
+
+    /**
+     * All declared plaintext was encoded.
+     * @return
+     */
+    bool isFinished() const;
+
+  };
+
+  /**
+   * Incremental decoder. Frame may be fed in pieces of any size, memory use is one block. <br>
+   * Output goes straight into caller-provided buffers - no allocations after construction.
+   * Reusable with `reset()`. The codec must outlive the decoder.
+   */
+  class Decoder {
+  private:
+    const RabinCodec* m_codec;
+    std::vector<uint8_t> m_scratch; // [wire block | c block | m block]
+    uint8_t m_header[HEADER_SIZE];
+    size_t m_headerSize;
+    size_t m_blockFill;
+    uint64_t m_remaining;
+  public:
+
+    /**
+     * Constructor.
+     * @param codec
+     */
+    Decoder(const RabinCodec& codec);
+
+    /**
+     * Start new frame.
+     */
+    void reset();
+
+    /**
+     * Upper bound of the output of `write(data, size, out)`.
+     * @param size
+     * @return
+     */
+    size_t getMaxOutputSize(size_t size) const;
+
+    /**
+     * Decrypt next piece of the frame.
+     * Throws `std::runtime_error` if the frame is malformed, a block fails the redundancy check,
+     * or data continues past the end of the frame.
+     * @param data
+     * @param size
+     * @param out - at least `getMaxOutputSize(size)` bytes.
+     * @return - number of plaintext bytes written to `out`.
+     */
+    size_t write(const void* data, size_t size, uint8_t* out);
+
+    /**
+     * Whole frame was decoded.
+     * @return
+     */
+    bool isFinished() const;
+
+  };
+
+private:
+  std::shared_ptr<const RabinBackend> m_backend;
+  int m_bits;
+  size_t m_blockSize;
+  size_t m_payloadSize;
+  size_t m_wireBlockSize;
+private:
+  static size_t computePayloadSize(int bits);
+  void writeHeader(uint64_t plaintextSize, uint8_t* out) const;
+  void encryptBlock(const uint8_t* payload, size_t size, uint8_t* m, uint8_t* out) const;
+  void decryptBlock(const uint8_t* in, uint8_t* c, uint8_t* m) const;
+public:
+
+  /**
+   * Constructor.
+   * @param backend - key. Modulus must be at least 10 bits.
+   */
+  RabinCodec(const std::shared_ptr<const RabinBackend>& backend);
+
+  /**
+   * Key used by this codec.
+   * @return
+   */
+  const std::shared_ptr<const RabinBackend>& getBackend() const;
+
+  /**
+   * Plaintext bytes per block.
+   * @return
+   */
+  size_t getPayloadSize() const;
+
+  /**
+   * Ciphertext bytes per block on the wire.
+   * @return
+   */
+  size_t getWireBlockSize() const;
+
+  /**
+   * Exact size of the encoded frame.
+   * @param plaintextSize
+   * @return
+   */
+  size_t getEncodedSize(size_t plaintextSize) const;
+
+  /**
+   * Encrypt plaintext into a frame.
+   * @param data
+   * @param size
+   * @return - binary frame.
+   */
+  std::string encode(const char* data, size_t size) const;
+
+  /**
+   * Decrypt frame produced by `encode()` with the same key.
+   * Throws `std::runtime_error` if frame is malformed, was made for a different modulus size or a different key.
+   * @param data
+   * @param size
+   * @return - plaintext.
+   */
+  std::string decode(const char* data, size_t size) const;
+
+};
+
+#endif // RabinCodec_hpp
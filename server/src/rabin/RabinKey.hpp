@@ -0,0 +1,459 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinKey_hpp
+#define RabinKey_hpp
+
+#include "./RabinBatch.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * Double-width integer for `Word` - holds a full product of two words.
+ * @tparam Word - `uint32_t` or `uint64_t`.
+ */
+template<typename Word>
+struct RabinWordTraits;
+
+template<>
+struct RabinWordTraits<uint32_t> {
+  typedef uint64_t DWord;
+  static constexpr int BITS = 32;
+};
+
+template<>
+struct RabinWordTraits<uint64_t> {
+  __extension__ typedef unsigned __int128 DWord;
+  static constexpr int BITS = 64;
+};
+
+/**
+ * Montgomery arithmetic modulo a fixed odd `mod < 2^(BITS - 1)`. <br>
+ * Values with the `Mont` suffix are in Montgomery form - `x * R (mod mod)`, `R = 2^BITS`.
+ * Reduction uses only multiplications and shifts on the double-width type - no division.
+ * @tparam Word - `uint32_t` or `uint64_t`.
+ */
+template<typename Word>
+class RabinMontgomery {
+public:
+  typedef typename RabinWordTraits<Word>::DWord DWord;
+  static constexpr int BITS = RabinWordTraits<Word>::BITS;
+private:
+  Word m_mod;
+  Word m_negInv; // -mod^-1 (mod R)
+  Word m_r1;     // R   (mod mod) - one in Montgomery form
+  Word m_r2;     // R^2 (mod mod)
+  Word m_r3;     // R^3 (mod mod)
+public:
+
+  RabinMontgomery()
+    : m_mod(0), m_negInv(0), m_r1(0), m_r2(0), m_r3(0)
+  {}
+
+  explicit RabinMontgomery(Word mod)
+    : m_mod(mod)
+  {
+    if((mod & 1) == 0 || (mod >> (BITS - 1)) != 0) {
+      throw std::runtime_error("[RabinMontgomery::RabinMontgomery()]: Error. Modulus must be odd and below 2^(BITS - 1).");
+    }
+    Word inv = mod; // correct to 3 bits, each Newton step doubles it
+    for(int i = 0; i < 5; i ++) {
+      inv *= Word(2) - mod * inv;
+    }
+    m_negInv = Word(0) - inv;
+    m_r1 = (Word(0) - mod) % mod;
+    m_r2 = Word((DWord(m_r1) * m_r1) % mod);
+    m_r3 = mul(m_r2, m_r2);
+  }
+
+  Word getModulus() const {
+    return m_mod;
+  }
+
+  /**
+   * `t * R^-1 (mod mod)`.
+   * @param t - `t < mod * R`.
+   * @return
+   */
+  Word reduce(DWord t) const {
+    Word m = Word(t) * m_negInv;
+    Word u = Word((t + DWord(m) * m_mod) >> BITS);
+    return u >= m_mod ? u - m_mod : u;
+  }
+
+  /**
+   * `a * b * R^-1 (mod mod)`. Montgomery product of Montgomery-form values.
+   */
+  Word mul(Word a, Word b) const {
+    return reduce(DWord(a) * b);
+  }
+
+  /**
+   * Convert `a < mod` into Montgomery form.
+   */
+  Word toMont(Word a) const {
+    return mul(a, m_r2);
+  }
+
+  /**
+   * Reduce any `a < mod * R` modulo `mod` and convert into Montgomery form.
+   */
+  Word reduceToMont(DWord a) const {
+    return mul(reduce(a), m_r3);
+  }
+
+  Word fromMont(Word aMont) const {
+    return reduce(aMont);
+  }
+
+  /**
+   * `base^exp` in Montgomery form.
+   */
+  Word powMont(Word baseMont, Word exp) const {
+    Word result = m_r1;
+    while(exp > 0) {
+      if(exp & 1) {
+        result = mul(result, baseMont);
+      }
+      baseMont = mul(baseMont, baseMont);
+      exp >>= 1;
+    }
+    return result;
+  }
+
+  /**
+   * `values[i]^exp` in Montgomery form for `N` values at once. <br>
+   * Square-and-multiply chains of independent values are interleaved,
+   * so the CPU overlaps their multiplications instead of waiting on each one.
+   * @tparam N - number of values.
+   * @param values - Montgomery-form bases, replaced with the results.
+   * @param exp - exponent.
+   */
+  template<size_t N>
+  void powMontTile(Word* values, Word exp) const {
+    Word result[N];
+    for(size_t i = 0; i < N; i ++) {
+      result[i] = m_r1;
+    }
+    while(exp > 0) {
+      if(exp & 1) {
+        for(size_t i = 0; i < N; i ++) {
+          result[i] = mul(result[i], values[i]);
+        }
+      }
+      for(size_t i = 0; i < N; i ++) {
+        values[i] = mul(values[i], values[i]);
+      }
+      exp >>= 1;
+    }
+    for(size_t i = 0; i < N; i ++) {
+      values[i] = result[i];
+    }
+  }
+
+  /**
+   * `a^2 (mod mod)` for a plain `a < mod` - two reductions, no conversion into Montgomery form.
+   */
+  Word squareMod(Word a) const {
+    return mul(reduce(DWord(a) * a), m_r2);
+  }
+
+};
+
+/**
+ * Immutable Rabin private key context. <br>
+ * Everything that depends only on the key - modulus, CRT coefficients, square-root exponents
+ * and Montgomery reduction constants - is computed once in the constructor,
+ * so encrypt/decrypt calls do no key setup and no heap allocation.
+ * Share one instance (usually as `std::shared_ptr<const RabinKey>`) between all users of the key. <br>
+ * Modulus must be below `2^(BITS - 1)` - up to 62-bit moduli with `uint64_t` words.
+ * @tparam Word - `uint32_t` or `uint64_t`.
+ */
+template<typename Word>
+class BasicRabinKey {
+public:
+  typedef Word WordType;
+  typedef typename RabinWordTraits<Word>::DWord DWord;
+public:
+
+  /**
+   * Number of ciphertexts decrypted in lockstep by `decryptBatch()`.
+   */
+  static constexpr size_t DECRYPT_TILE = 8;
+
+  /**
+   * Smallest share of a batch worth a separate thread.
+   */
+  static constexpr size_t DECRYPT_MIN_PER_THREAD = 16 * 1024;
+
+private:
+  Word m_p; // larger prime
+  Word m_q; // smaller prime
+  Word m_n;
+private:
+  RabinMontgomery<Word> m_montP;
+  RabinMontgomery<Word> m_montQ;
+  RabinMontgomery<Word> m_montN;
+  Word m_expP;     // (p + 1) / 4
+  Word m_expQ;     // (q + 1) / 4
+  Word m_qInv;     // q^-1 (mod p)
+  uint32_t m_batchN;  // n clamped to 32 bits - for RabinBatch
+  uint32_t m_batchMu; // Barrett constant of n - for RabinBatch
+private:
+
+  /*
+   * Combine roots modulo p and q (Garner).
+   */
+  Word crt(Word mpMont, Word mq) const {
+    Word mqMont = m_montP.toMont(mq); // mq < q < p
+    Word diff = mpMont >= mqMont ? mpMont - mqMont : mpMont + m_p - mqMont;
+    Word h = m_montP.mul(diff, m_qInv); // Montgomery form times plain value - plain result
+    return mq + m_q * h;
+  }
+
+  /*
+   * Single-threaded part of decryptBatch().
+   */
+  void decryptRange(const Word* c, const int8_t* jacobi, size_t count, Word* out) const {
+
+    Word mp[DECRYPT_TILE];
+    Word mq[DECRYPT_TILE];
+
+    size_t pos = 0;
+    for(; pos + DECRYPT_TILE <= count; pos += DECRYPT_TILE) {
+
+      for(size_t i = 0; i < DECRYPT_TILE; i ++) {
+        mp[i] = m_montP.reduceToMont(c[pos + i]);
+        mq[i] = m_montQ.reduceToMont(c[pos + i]);
+      }
+
+      m_montP.template powMontTile<DECRYPT_TILE>(mp, m_expP);
+      m_montQ.template powMontTile<DECRYPT_TILE>(mq, m_expQ);
+
+      for(size_t i = 0; i < DECRYPT_TILE; i ++) {
+        Word q = m_montQ.fromMont(mq[i]);
+        if(jacobi[pos + i] < 0 && q != 0) {
+          q = m_q - q;
+        }
+        Word x = crt(mp[i], q);
+        Word y = m_n - x;
+        out[pos + i] = x < y ? x : y;
+      }
+
+    }
+
+    for(; pos < count; pos ++) {
+      out[pos] = decryptBlock(c[pos], jacobi[pos]);
+    }
+
+  }
+
+  /*
+   * Roots of `c` modulo p (Montgomery form) and modulo q (plain).
+   */
+  void halfRoots(Word c, Word& mpMont, Word& mq) const {
+    mpMont = m_montP.powMont(m_montP.reduceToMont(c), m_expP);
+    mq = m_montQ.fromMont(m_montQ.powMont(m_montQ.reduceToMont(c), m_expQ));
+  }
+
+public:
+
+  /**
+   * Constructor.
+   * @param p - prime, `p = 3 (mod 4)`.
+   * @param q - prime, `q = 3 (mod 4)`, `q != p`.
+   */
+  BasicRabinKey(Word p, Word q)
+    : m_p(p > q ? p : q)
+    , m_q(p > q ? q : p)
+  {
+    if(p % 4 != 3 || q % 4 != 3 || p == q) {
+      throw std::runtime_error("[BasicRabinKey::BasicRabinKey()]: Error. Primes must be distinct and = 3 (mod 4).");
+    }
+    if(DWord(m_p) * m_q >= (DWord(1) << (RabinWordTraits<Word>::BITS - 1))) {
+      throw std::runtime_error("[BasicRabinKey::BasicRabinKey()]: Error. Modulus is too large for the word size.");
+    }
+    m_n = m_p * m_q;
+    m_montP = RabinMontgomery<Word>(m_p);
+    m_montQ = RabinMontgomery<Word>(m_q);
+    m_montN = RabinMontgomery<Word>(m_n);
+    m_expP = (m_p + 1) / 4;
+    m_expQ = (m_q + 1) / 4;
+    m_qInv = m_montP.fromMont(m_montP.powMont(m_montP.toMont(m_q), m_p - 2)); // Fermat: q^(p - 2)
+    m_batchN = (uint64_t) m_n > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (uint32_t) m_n;
+    m_batchMu = RabinBatch::getBarrettConstant(m_n);
+  }
+
+  /**
+   * Larger of the two primes.
+   */
+  Word getP() const {
+    return m_p;
+  }
+
+  /**
+   * Smaller of the two primes.
+   */
+  Word getQ() const {
+    return m_q;
+  }
+
+  /**
+   * Public modulus `n = p * q`.
+   */
+  Word getN() const {
+    return m_n;
+  }
+
+  /**
+   * `c = m^2 (mod n)`.
+   * @param m - plaintext, `0 <= m < n`.
+   * @return - ciphertext.
+   */
+  Word encrypt(Word m) const {
+    return m_montN.squareMod(m);
+  }
+
+  /**
+   * Encrypt each byte as a separate number - `out[i] = in[i]^2 (mod n)`.
+   * Vectorized (AVX2) if the CPU supports it, see `RabinBatch`.
+   * @param in - plaintext bytes.
+   * @param count - number of bytes.
+   * @param out - `count` ciphertexts. Ciphertext of a byte always fits 32 bits.
+   */
+  void encryptBatch(const uint8_t* in, size_t count, uint32_t* out) const {
+    RabinBatch::encryptBytes(in, count, m_batchN, m_batchMu, out);
+  }
+
+  /**
+   * Compute all four square roots of `c` modulo `n`.
+   * @param c - ciphertext, `c < n`.
+   * @param roots - output, `roots[0..1]` and `roots[2..3]` are `{r, n - r}` pairs.
+   */
+  void roots(Word c, Word roots[4]) const {
+    Word mpMont, mq;
+    halfRoots(c, mpMont, mq);
+    Word x = crt(mpMont, mq);
+    Word y = crt(mpMont, mq == 0 ? 0 : m_q - mq);
+    roots[0] = x;
+    roots[1] = x == 0 ? 0 : m_n - x;
+    roots[2] = y;
+    roots[3] = y == 0 ? 0 : m_n - y;
+  }
+
+  /**
+   * Jacobi symbol `(m / n)`. Public operation - needs only the modulus.
+   * @param m - `m < n`.
+   * @return - `-1`, `0` or `1`.
+   */
+  int jacobi(Word m) const {
+    return jacobiSymbol(m, m_n);
+  }
+
+  /**
+   * Jacobi symbol `(a / n)`.
+   * @param a - `a < n`.
+   * @param n - odd modulus.
+   * @return - `-1`, `0` or `1`.
+   */
+  static int jacobiSymbol(Word a, Word n) {
+    int result = 1;
+    while(a != 0) {
+      while((a & 1) == 0) {
+        a >>= 1;
+        Word r = n & 7;
+        if(r == 3 || r == 5) result = -result;
+      }
+      Word t = a; a = n; n = t;
+      if((a & 3) == 3 && (n & 3) == 3) result = -result;
+      a %= n;
+    }
+    return n == 1 ? result : 0;
+  }
+
+  /**
+   * The square root of `c` which has the given Jacobi symbol and is below `n / 2`. <br>
+   * For `p = q = 3 (mod 4)` the four roots are `{x, n - x}` with `(x / n) = 1` and `{y, n - y}` with `(y / n) = -1`,
+   * so the Jacobi symbol and the half-range condition select exactly one root - no trial of all four is needed.
+   * @param c - ciphertext.
+   * @param jacobi - Jacobi symbol of the plaintext. `0` is treated as `1`.
+   * @return - plaintext.
+   */
+  Word decryptBlock(Word c, int jacobi) const {
+    Word mpMont, mq;
+    halfRoots(c, mpMont, mq);
+    if(jacobi < 0 && mq != 0) {
+      mq = m_q - mq;
+    }
+    Word x = crt(mpMont, mq);
+    Word y = m_n - x;
+    return x < y ? x : y;
+  }
+
+  /**
+   * Decrypt a batch of block ciphertexts - same result as `decryptBlock()` for each element. <br>
+   * Each thread takes a contiguous range and walks it in tiles of `DECRYPT_TILE` ciphertexts
+   * whose exponentiations run interleaved. All CRT constants come from the key, so no inversions are done per element.
+   * @param c - ciphertexts.
+   * @param jacobi - Jacobi symbols of the plaintexts.
+   * @param count - number of ciphertexts.
+   * @param out - `count` plaintexts.
+   * @param threads - max number of threads, `0` - number of hardware threads.
+   */
+  void decryptBatch(const Word* c, const int8_t* jacobi, size_t count, Word* out, unsigned threads = 0) const {
+    RabinBatch::forEachShare(count, threads, DECRYPT_MIN_PER_THREAD, [this, c, jacobi, out](size_t start, size_t size) {
+      decryptRange(c + start, jacobi + start, size, out + start);
+    });
+  }
+
+  /**
+   * Decrypt single ASCII character - the only square root of `c` which is below 128.
+   * @param c - ciphertext.
+   * @return - plaintext or `-1` if no root is a valid ASCII code.
+   */
+  int decrypt(Word c) const {
+    Word r[4];
+    roots(c, r);
+    for(int i = 0; i < 4; i ++) {
+      if(r[i] < 128) {
+        return (int) r[i];
+      }
+    }
+    return -1;
+  }
+
+};
+
+template<typename Word>
+constexpr size_t BasicRabinKey<Word>::DECRYPT_TILE;
+
+template<typename Word>
+constexpr size_t BasicRabinKey<Word>::DECRYPT_MIN_PER_THREAD;
+
+typedef BasicRabinKey<uint64_t> RabinKey;
+
+#endif // RabinKey_hpp
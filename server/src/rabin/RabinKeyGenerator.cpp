@@ -0,0 +1,164 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "RabinKeyGenerator.hpp"
+
+#include "./RabinKey.hpp"
+#include "./BigRabinKey.hpp"
+
+#include <openssl/rand.h>
+
+constexpr int RabinKeyGenerator::MIN_KEY_BITS;
+constexpr int RabinKeyGenerator::MAX_SMALL_KEY_BITS;
+
+namespace {
+
+uint64_t randomWord() {
+  uint64_t result;
+  if(RAND_bytes((unsigned char*) &result, sizeof(result)) != 1) {
+    throw std::runtime_error("[RabinKeyGenerator]: Error. RAND_bytes failed.");
+  }
+  return result;
+}
+
+struct BigNumber {
+
+  BIGNUM* value;
+
+  BigNumber()
+    : value(BN_new())
+  {
+    if(!value) {
+      throw std::runtime_error("[RabinKeyGenerator]: Error. BN_new failed.");
+    }
+  }
+
+  ~BigNumber() {
+    BN_clear_free(value);
+  }
+
+};
+
+}
+
+bool RabinKeyGenerator::isPrime(uint64_t n) {
+
+  static const uint64_t SMALL_PRIMES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+  if(n < 2) {
+    return false;
+  }
+  for(uint64_t p : SMALL_PRIMES) {
+    if(n % p == 0) {
+      return n == p;
+    }
+  }
+
+  /* these bases are enough for all n < 3.3 * 10^24 */
+  uint64_t d = n - 1;
+  int s = 0;
+  while((d & 1) == 0) {
+    d >>= 1;
+    ++ s;
+  }
+
+  RabinMontgomery<uint64_t> mont(n);
+  uint64_t one = mont.toMont(1);
+  uint64_t minusOne = mont.toMont(n - 1);
+
+  for(uint64_t a : SMALL_PRIMES) {
+    uint64_t x = mont.powMont(mont.toMont(a), d);
+    if(x == one || x == minusOne) {
+      continue;
+    }
+    bool composite = true;
+    for(int i = 1; i < s; i ++) {
+      x = mont.mul(x, x);
+      if(x == minusOne) {
+        composite = false;
+        break;
+      }
+    }
+    if(composite) {
+      return false;
+    }
+  }
+
+  return true;
+
+}
+
+uint64_t RabinKeyGenerator::generateBlumPrime(int bits) {
+  if(bits < 4 || bits > 31) {
+    throw std::runtime_error("[RabinKeyGenerator::generateBlumPrime()]: Error. Invalid prime size.");
+  }
+  const uint64_t mask = (1ULL << bits) - 1;
+  const uint64_t top = 3ULL << (bits - 2);
+  while(true) {
+    uint64_t candidate = (randomWord() & mask) | top | 3;
+    if(isPrime(candidate)) {
+      return candidate;
+    }
+  }
+}
+
+std::shared_ptr<const RabinBackend> RabinKeyGenerator::generate(int bits) {
+
+  if(bits < MIN_KEY_BITS) {
+    throw std::runtime_error("[RabinKeyGenerator::generate()]: Error. Key is too small.");
+  }
+
+  int pBits = (bits + 1) / 2;
+  int qBits = bits - pBits;
+
+  if(bits <= MAX_SMALL_KEY_BITS) {
+    /* two top bits set in both primes - the product has exactly pBits + qBits bits */
+    uint64_t p = generateBlumPrime(pBits);
+    uint64_t q;
+    do {
+      q = generateBlumPrime(qBits);
+    } while(q == p);
+    return std::make_shared<SmallRabinBackend<RabinKey>>(std::make_shared<RabinKey>(p, q));
+  }
+
+  BigNumber p, q, n, add, rem;
+  if(!BN_set_word(add.value, 4) || !BN_set_word(rem.value, 3)) {
+    throw std::runtime_error("[RabinKeyGenerator::generate()]: Error. BN_set_word failed.");
+  }
+
+  BN_CTX* ctx = BigRabinKey::getThreadContext();
+  if(!BN_generate_prime_ex(p.value, pBits, 0, add.value, rem.value, nullptr)) {
+    throw std::runtime_error("[RabinKeyGenerator::generate()]: Error. BN_generate_prime_ex failed.");
+  }
+  do {
+    if(!BN_generate_prime_ex(q.value, qBits, 0, add.value, rem.value, nullptr) || !BN_mul(n.value, p.value, q.value, ctx)) {
+      throw std::runtime_error("[RabinKeyGenerator::generate()]: Error. BN_generate_prime_ex failed.");
+    }
+  } while(BN_num_bits(n.value) != bits || BN_cmp(p.value, q.value) == 0);
+
+  return std::make_shared<BigRabinKey>(p.value, q.value);
+
+}
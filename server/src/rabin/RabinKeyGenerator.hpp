@@ -0,0 +1,67 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinKeyGenerator_hpp
+#define RabinKeyGenerator_hpp
+
+#include "./RabinBackend.hpp"
+
+/**
+ * Generation of Rabin keys from Blum primes (`p = q = 3 (mod 4)`). <br>
+ * Keys up to `MAX_SMALL_KEY_BITS` are machine-word `RabinKey`s with primes found by deterministic Miller-Rabin,
+ * larger keys are `BigRabinKey`s with primes from OpenSSL (probabilistic Miller-Rabin).
+ * Randomness comes from the OpenSSL CSPRNG.
+ */
+class RabinKeyGenerator {
+public:
+  static constexpr int MIN_KEY_BITS = 16;
+  static constexpr int MAX_SMALL_KEY_BITS = 62;
+public:
+
+  /**
+   * Deterministic Miller-Rabin for 64-bit numbers.
+   * @param n - `n < 2^63`.
+   * @return
+   */
+  static bool isPrime(uint64_t n);
+
+  /**
+   * Random Blum prime of exactly `bits` bits with the two top bits set.
+   * @param bits - `4 <= bits <= 31`.
+   * @return
+   */
+  static uint64_t generateBlumPrime(int bits);
+
+  /**
+   * Generate new key with modulus of exactly `bits` bits.
+   * @param bits - `MIN_KEY_BITS <= bits`.
+   * @return
+   */
+  static std::shared_ptr<const RabinBackend> generate(int bits);
+
+};
+
+#endif // RabinKeyGenerator_hpp
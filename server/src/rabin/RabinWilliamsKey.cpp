@@ -0,0 +1,249 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "RabinWilliamsKey.hpp"
+
+#include <openssl/evp.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+void check(int result, const char* what) {
+  if(!result) {
+    throw std::runtime_error(std::string("[RabinWilliamsKey]: Error. OpenSSL call failed - ") + what);
+  }
+}
+
+class ContextFrame {
+private:
+  BN_CTX* m_ctx;
+public:
+
+  ContextFrame(BN_CTX* ctx)
+    : m_ctx(ctx)
+  {
+    BN_CTX_start(m_ctx);
+  }
+
+  ~ContextFrame() {
+    BN_CTX_end(m_ctx);
+  }
+
+  BIGNUM* get() {
+    BIGNUM* result = BN_CTX_get(m_ctx);
+    check(result != nullptr, "BN_CTX_get");
+    return result;
+  }
+
+};
+
+}
+
+std::shared_ptr<RabinWilliamsKey> RabinWilliamsKey::generate(int bits) {
+
+  if(bits < 256) {
+    throw std::runtime_error("[RabinWilliamsKey::generate()]: Error. Key is too small.");
+  }
+
+  BN_CTX* ctx = BigRabinKey::getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* p = frame.get();
+  BIGNUM* q = frame.get();
+  BIGNUM* n = frame.get();
+  BIGNUM* add = frame.get();
+  BIGNUM* remP = frame.get();
+  BIGNUM* remQ = frame.get();
+
+  check(BN_set_word(add, 8) && BN_set_word(remP, 3) && BN_set_word(remQ, 7), "BN_set_word");
+
+  int pBits = (bits + 1) / 2;
+  int qBits = bits - pBits;
+
+  check(BN_generate_prime_ex(p, pBits, 0, add, remP, nullptr), "BN_generate_prime_ex");
+  do {
+    check(BN_generate_prime_ex(q, qBits, 0, add, remQ, nullptr), "BN_generate_prime_ex");
+    check(BN_mul(n, p, q, ctx), "BN_mul");
+  } while(BN_num_bits(n) != bits);
+
+  auto result = std::make_shared<RabinWilliamsKey>(p, q);
+  BN_clear(p);
+  BN_clear(q);
+  return result;
+
+}
+
+RabinWilliamsKey::RabinWilliamsKey(const BIGNUM* p, const BIGNUM* q)
+  : m_p(nullptr)
+  , m_q(nullptr)
+{
+
+  if(BN_mod_word(p, 8) != 3 || BN_mod_word(q, 8) != 7) {
+    throw std::runtime_error("[RabinWilliamsKey::RabinWilliamsKey()]: Error. Primes must be p = 3 (mod 8), q = 7 (mod 8).");
+  }
+
+  try {
+    m_p = BN_dup(p);
+    m_q = BN_dup(q);
+    check(m_p && m_q, "BN_dup");
+    BN_set_flags(m_p, BN_FLG_CONSTTIME);
+    BN_set_flags(m_q, BN_FLG_CONSTTIME);
+    m_key.reset(new BigRabinKey(p, q));
+    m_signatureSize = m_key->getBlockSize();
+  } catch (...) {
+    release();
+    throw;
+  }
+
+}
+
+RabinWilliamsKey::~RabinWilliamsKey() {
+  release();
+}
+
+void RabinWilliamsKey::release() {
+  BN_clear_free(m_p);
+  BN_clear_free(m_q);
+}
+
+void RabinWilliamsKey::hashToNumber(const uint8_t* digest, size_t digestSize, size_t size, BIGNUM* h) {
+
+  /* MGF1 with SHA-256 - SHA256(digest || counter) blocks, counter is big-endian 32-bit */
+  std::vector<uint8_t> input(digest, digest + digestSize);
+  input.resize(digestSize + 4);
+  std::vector<uint8_t> buffer(size + 32);
+
+  for(uint32_t counter = 0; counter * 32 < size; counter ++) {
+    input[digestSize + 0] = (uint8_t) (counter >> 24);
+    input[digestSize + 1] = (uint8_t) (counter >> 16);
+    input[digestSize + 2] = (uint8_t) (counter >> 8);
+    input[digestSize + 3] = (uint8_t) counter;
+    check(EVP_Digest(input.data(), input.size(), buffer.data() + counter * 32, nullptr, EVP_sha256(), nullptr), "EVP_Digest");
+  }
+
+  check(BN_bin2bn(buffer.data(), (int) size, h) != nullptr, "BN_bin2bn");
+
+}
+
+bool RabinWilliamsKey::verify(const BIGNUM* n, const uint8_t* digest, size_t digestSize, const uint8_t* signature, size_t signatureSize) {
+
+  if(signatureSize != (size_t) BN_num_bytes(n)) {
+    return false;
+  }
+
+  BN_CTX* ctx = BigRabinKey::getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* s = frame.get();
+  BIGNUM* t = frame.get();
+  BIGNUM* h = frame.get();
+
+  check(BN_bin2bn(signature, (int) signatureSize, s) != nullptr, "BN_bin2bn");
+  if(BN_cmp(s, n) >= 0) {
+    return false;
+  }
+
+  check(BN_mod_sqr(t, s, n, ctx), "BN_mod_sqr");
+  hashToNumber(digest, digestSize, signatureSize - 1, h);
+
+  for(int f = 0; f < 2; f ++) {
+    if(f == 1) {
+      check(BN_mod_lshift1_quick(h, h, n), "BN_mod_lshift1_quick");
+    }
+    if(BN_cmp(t, h) == 0) {
+      return true;
+    }
+    check(BN_sub(s, n, h), "BN_sub"); // -h
+    if(BN_cmp(t, s) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
+const BIGNUM* RabinWilliamsKey::getN() const {
+  return m_key->getN();
+}
+
+std::string RabinWilliamsKey::getModulusHex() const {
+  char* hex = BN_bn2hex(m_key->getN());
+  check(hex != nullptr, "BN_bn2hex");
+  std::string result(hex);
+  OPENSSL_free(hex);
+  for(auto& c : result) {
+    if(c >= 'A' && c <= 'F') {
+      c = (char) (c - 'A' + 'a');
+    }
+  }
+  return result;
+}
+
+size_t RabinWilliamsKey::getSignatureSize() const {
+  return m_signatureSize;
+}
+
+void RabinWilliamsKey::sign(const uint8_t* digest, size_t digestSize, uint8_t* signature) const {
+
+  BN_CTX* ctx = BigRabinKey::getThreadContext();
+  ContextFrame frame(ctx);
+  BIGNUM* x = frame.get();
+  BIGNUM* r[4];
+  for(int i = 0; i < 4; i ++) {
+    r[i] = frame.get();
+  }
+
+  hashToNumber(digest, digestSize, m_signatureSize - 1, x);
+
+  int legendreP = BN_kronecker(x, m_p, ctx);
+  int legendreQ = BN_kronecker(x, m_q, ctx);
+  check(legendreP != -2 && legendreQ != -2, "BN_kronecker");
+  if(legendreP == 0 || legendreQ == 0) {
+    throw std::runtime_error("[RabinWilliamsKey::sign()]: Error. Digest maps to a multiple of a key prime.");
+  }
+
+  /* (-1/q) = -1 and (2/q) = 1 - `e` makes x a residue modulo q, `f` doesn't change that */
+  int e = legendreQ;
+  /* (-1/p) = -1 and (2/p) = -1 - `f` fixes the residue modulo p */
+  int f = legendreP * e == 1 ? 1 : 2;
+
+  const BIGNUM* n = m_key->getN();
+  if(f == 2) {
+    check(BN_mod_lshift1_quick(x, x, n), "BN_mod_lshift1_quick");
+  }
+  if(e == -1) {
+    check(BN_sub(x, n, x), "BN_sub");
+  }
+
+  m_key->roots(x, r, ctx);
+  check(BN_bn2binpad(r[0], signature, (int) m_signatureSize) >= 0, "BN_bn2binpad");
+
+}
+
+bool RabinWilliamsKey::verify(const uint8_t* digest, size_t digestSize, const uint8_t* signature) const {
+  return verify(m_key->getN(), digest, digestSize, signature, m_signatureSize);
+}
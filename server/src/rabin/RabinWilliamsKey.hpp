@@ -0,0 +1,127 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinWilliamsKey_hpp
+#define RabinWilliamsKey_hpp
+
+#include "./BigRabinKey.hpp"
+
+#include <memory>
+#include <string>
+
+/**
+ * Rabin-Williams signature key - `p = 3 (mod 8)`, `q = 7 (mod 8)`. <br>
+ * Message digest `d` is expanded to `h = 0x00 || MGF1-SHA256(d)`, one byte shorter than the modulus,
+ * and the signature is a square root `s` of `e * f * h (mod n)` with the tweaks `e` in `{1, -1}` and `f` in `{1, 2}`
+ * chosen to make it a quadratic residue. <br>
+ * Verification is a single modular squaring: `s^2 (mod n)` must be one of `h`, `-h`, `2h`, `-2h`.
+ * Signatures are big-endian, `getSignatureSize()` bytes.
+ */
+class RabinWilliamsKey {
+private:
+  BIGNUM* m_p; // = 3 (mod 8)
+  BIGNUM* m_q; // = 7 (mod 8)
+  std::unique_ptr<BigRabinKey> m_key;
+  size_t m_signatureSize;
+private:
+  void release();
+  static void hashToNumber(const uint8_t* digest, size_t digestSize, size_t size, BIGNUM* h);
+public:
+
+  /**
+   * Generate new key with modulus of exactly `bits` bits.
+   * @param bits - `bits >= 256`.
+   * @return
+   */
+  static std::shared_ptr<RabinWilliamsKey> generate(int bits);
+
+  /**
+   * Verify signature by public modulus only.
+   * @param n - public modulus.
+   * @param digest - signed digest.
+   * @param digestSize - size of the digest in bytes.
+   * @param signature - signature.
+   * @param signatureSize - size of the signature in bytes.
+   * @return - `true` if the signature is valid.
+   */
+  static bool verify(const BIGNUM* n, const uint8_t* digest, size_t digestSize, const uint8_t* signature, size_t signatureSize);
+
+public:
+
+  /**
+   * Constructor. Primes are copied.
+   * @param p - prime, `p = 3 (mod 8)`.
+   * @param q - prime, `q = 7 (mod 8)`.
+   */
+  RabinWilliamsKey(const BIGNUM* p, const BIGNUM* q);
+
+  RabinWilliamsKey(const RabinWilliamsKey&) = delete;
+  RabinWilliamsKey& operator=(const RabinWilliamsKey&) = delete;
+
+  /**
+   * Destructor.
+   */
+  ~RabinWilliamsKey();
+
+  /**
+   * Public modulus `n = p * q`.
+   * @return
+   */
+  const BIGNUM* getN() const;
+
+  /**
+   * Public modulus as lowercase hex string.
+   * @return
+   */
+  std::string getModulusHex() const;
+
+  /**
+   * Size of signature in bytes - size of the modulus.
+   * @return
+   */
+  size_t getSignatureSize() const;
+
+  /**
+   * Sign digest. <br>
+   * The same digest always gets the same signature - releasing two different roots of one value reveals the factors.
+   * @param digest - digest to sign.
+   * @param digestSize - size of the digest in bytes.
+   * @param signature - output, `getSignatureSize()` bytes.
+   */
+  void sign(const uint8_t* digest, size_t digestSize, uint8_t* signature) const;
+
+  /**
+   * Verify signature made by this key.
+   * @param digest - signed digest.
+   * @param digestSize - size of the digest in bytes.
+   * @param signature - signature, `getSignatureSize()` bytes.
+   * @return - `true` if the signature is valid.
+   */
+  bool verify(const uint8_t* digest, size_t digestSize, const uint8_t* signature) const;
+
+};
+
+#endif // RabinWilliamsKey_hpp
@@ -1,145 +1,108 @@
 #ifndef RABIN
 #define RABIN
 
+#include "rabin/RabinKey.hpp"
+#include "rabin/RabinBackend.hpp"
+#include "rabin/RabinCodec.hpp"
+
 #include <iostream>
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstring>
 #include <sstream>
+#include <stdexcept>
 using namespace std;
 
+/**
+ * Encode/decode a message with the framed binary format of `RabinCodec`.
+ * Thin wrapper over `RabinCodec::Encoder`/`RabinCodec::Decoder` - use those directly
+ * to stream large inputs into caller-provided buffers. <br>
+ * Not copyable or movable - the encoder and decoder point to the `codec` member.
+ */
 class RabinCryptosystem {
 private:
-    int p;
-    int q;
-    int n;
-    vector<int> l;
+    std::shared_ptr<const RabinKey> key; // machine-word key, if any
+    RabinCodec codec;
+    RabinCodec::Encoder encoder;
+    RabinCodec::Decoder decoder;
     string s;
-
-    int modulo(int a, int b) {
-        return a >= 0 ? a % b : (b - abs(a % b)) % b;
-    }
-
-    int mod(int k, int b, int m) {
-        int i = 0;
-        int a = 1;
-        std::vector<int> t;
-        while (k > 0) {
-            t.push_back(k % 2);
-            k = (k - t[i]) / 2;
-            i++;
-        }
-        for (int j = 0; j < i; j++) {
-            if (t[j] == 1) {
-                a = (a * b) % m;
-                b = (b * b) % m;
-            } else {
-                b = (b * b) % m;
-            }
-        }
-        return a;
-    }
-
-    std::vector<int> eea(int a, int b) {
-        if (b > a) {
-            int temp = a;
-            a = b;
-            b = temp;
-        }
-        int x = 0;
-        int y = 1;
-        int lastx = 1;
-        int lasty = 0;
-        while (b != 0) {
-            int q = a / b;
-            int temp1 = a % b;
-            a = b;
-            b = temp1;
-            int temp2 = x;
-            x = lastx - q * x;
-            lastx = temp2;
-            int temp3 = y;
-            y = lasty - q * y;
-            lasty = temp3;
-        }
-        std::vector<int> arr(3);
-        arr[0] = lastx;
-        arr[1] = lasty;
-        arr[2] = 1;
-        return arr;
-    }
+    string encoded;
 
 public:
-    RabinCryptosystem(int prime1, int prime2, string plaintext) : p(prime1), q(prime2), s(plaintext) {
-        n = p * q;
+    RabinCryptosystem(RabinKey::WordType prime1, RabinKey::WordType prime2, string plaintext)
+        : RabinCryptosystem(std::make_shared<RabinKey>(prime1, prime2), std::move(plaintext)) {}
+
+    /**
+     * Use already precomputed key. The key is shared, not copied.
+     */
+    RabinCryptosystem(const std::shared_ptr<const RabinKey>& rabinKey, string plaintext)
+        : key(rabinKey)
+        , codec(std::make_shared<SmallRabinBackend<RabinKey>>(rabinKey))
+        , encoder(codec, plaintext.size())
+        , decoder(codec)
+        , s(std::move(plaintext)) {}
+
+    /**
+     * Use any key backend, e.g. multi-precision `BigRabinKey`.
+     */
+    RabinCryptosystem(const std::shared_ptr<const RabinBackend>& rabinBackend, string plaintext)
+        : codec(rabinBackend)
+        , encoder(codec, plaintext.size())
+        , decoder(codec)
+        , s(std::move(plaintext)) {}
+
+    RabinCryptosystem(const RabinCryptosystem&) = delete;
+    RabinCryptosystem& operator=(const RabinCryptosystem&) = delete;
+    RabinCryptosystem(RabinCryptosystem&&) = delete;
+    RabinCryptosystem& operator=(RabinCryptosystem&&) = delete;
+
+    /**
+     * Encrypt single character. Only for machine-word keys.
+     * Takes `unsigned char` - a negative `char` would sign-extend to a word above the modulus.
+     */
+    RabinKey::WordType encrypt(unsigned char m) {
+        return key->encrypt((RabinKey::WordType) m);
     }
 
-    int encrypt(int m) {
-        return (m * m) % n;
+    /**
+     * Decrypt single ASCII character. Only for machine-word keys.
+     * @return - character code below 128, or `-1` if there is none.
+     */
+    int decrypt(RabinKey::WordType c) {
+        return key->decrypt(c);
     }
 
-    int decrypt(int c) {
-        int mp = mod((p + 1) / 4, c, p);
-        int mq = mod((q + 1) / 4, c, q);
-        std::vector<int> arr = eea(p, q);
-        int pp = arr[0] * p * mq;
-        int qq = arr[1] * q * mp;
-        double r = modulo((pp + qq), n);
-        if (r < 128)
-            return r;
-        int negative_r = n - r;
-        if (negative_r < 128)
-            return negative_r;
-        int s = modulo((pp - qq), n);
-        if (s < 128)
-            return s;
-        int negative_s = n - s;
-        if (negative_s < 128)
-            return negative_s;
+    const RabinCodec& getCodec() const {
+        return codec;
     }
 
-    string encode() {
-        std::vector<int> l_;
-        for (char c : s) {
-            l_.push_back((int)this->encrypt(c));
-        }
-        l = l_;
-        std::ostringstream oss;
-        std::copy(l.begin(), l.end(), std::ostream_iterator<int>(oss, ""));
-        return oss.str();
+    /**
+     * Encrypt the plaintext.
+     * @return - binary frame, see `RabinCodec`.
+     */
+    const string& encode() {
+        encoded.resize(codec.getEncodedSize(s.size()));
+        encoder.reset(s.size());
+        encoder.write(s.data(), s.size(), (uint8_t*) &encoded[0]);
+        return encoded;
     }
 
+    /**
+     * Decrypt the frame produced by the last `encode()` call.
+     * Throws `std::runtime_error` if the frame is malformed or truncated, same as `RabinCodec::decode()`.
+     */
     string decode() {
-        std::vector<char> l_;
-        for (int i : l) {
-            l_.push_back(char(this->decrypt(i)));
+        decoder.reset();
+        string result(decoder.getMaxOutputSize(encoded.size()), '\0');
+        result.resize(decoder.write(encoded.data(), encoded.size(), (uint8_t*) &result[0]));
+        if(!decoder.isFinished()) {
+            throw std::runtime_error("[RabinCryptosystem::decode()]: Error. Frame is truncated.");
         }
-        std::ostringstream oss;
-        std::copy(l_.begin(), l_.end(), std::ostream_iterator<char>(oss, ""));
-        return oss.str();
+        return result;
     }
 };
 
 #endif // RABIN
-
-
-// int main() {
-//     RabinCryptosystem cryptosystem(167, 151, "Rabin Cryptosystem");
-
-//     std::string test = "Rabin Cryptosystem";
-//     std::cout << "Message: " << test << std::endl;
-
-//     string encryptedMessage = cryptosystem.encode();
-
-//     std::cout << "Encryption: ";
-//     cout << encryptedMessage;
-
-//     std::cout << "\nDecoded message: ";
-//     string result = cryptosystem.decode();
-
-//     std::cout << result << std::endl;
-
-//     return 0;
-// }
@@ -30,13 +30,15 @@ v_int64 Lobby::obtainNewPeerId() {
   return m_peerIdCounter ++;
 }
 
-std::shared_ptr<Room> Lobby::getOrCreateRoom(const oatpp::String& roomName) {
+std::shared_ptr<Room> Lobby::createRoom(const oatpp::String& roomName, const std::shared_ptr<const RabinBackend>& key) {
   std::lock_guard<std::mutex> lock(m_roomsMutex);
-  std::shared_ptr<Room>& room = m_rooms[roomName];
-  if(!room) {
-    room = std::make_shared<Room>(roomName);
+  std::shared_ptr<Room>& slot = m_rooms[roomName];
+  if(!slot) {
+    slot = std::make_shared<Room>(roomName, key);
+  } else {
+    m_keyPool->recycle(key);
   }
-  return room;
+  return slot;
 }
 
 std::shared_ptr<Room> Lobby::getRoom(const oatpp::String& roomName) {
@@ -53,6 +55,16 @@ void Lobby::deleteRoom(const oatpp::String& roomName) {
   m_rooms.erase(roomName);
 }
 
+std::vector<std::shared_ptr<Room>> Lobby::getRoomsSnapshot() {
+  std::lock_guard<std::mutex> lock(m_roomsMutex);
+  std::vector<std::shared_ptr<Room>> rooms;
+  rooms.reserve(m_rooms.size());
+  for (const auto &room : m_rooms) {
+    rooms.push_back(room.second);
+  }
+  return rooms;
+}
+
 void Lobby::runPingLoop(const std::chrono::duration<v_int64, std::micro>& interval) {
 
   while(true) {
@@ -65,12 +77,129 @@ void Lobby::runPingLoop(const std::chrono::duration<v_int64, std::micro>& interv
       elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - startTime);
     } while (elapsed < interval);
 
-    std::lock_guard<std::mutex> lock(m_roomsMutex);
-    for (const auto &room : m_rooms) {
-      room.second->pingAllPeers();
+    for (const auto &room : getRoomsSnapshot()) {
+      room->pingAllPeers();
+    }
+
+  }
+
+}
+
+void Lobby::runRoomTickLoop(const std::chrono::duration<v_int64, std::micro>& interval) {
+
+  while(true) {
+
+    std::this_thread::sleep_for(interval);
+
+    for (const auto &room : getRoomsSnapshot()) {
+      room->sendTypingPeers();
+      room->signPendingMessages();
+    }
+
+  }
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Lobby::PendingJoin
+
+std::shared_ptr<Peer> Lobby::PendingJoin::getPeer() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_peer;
+}
+
+oatpp::async::CoroutineStarter Lobby::PendingJoin::onPing(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) {
+  auto peer = getPeer();
+  return peer ? peer->onPing(socket, message) : nullptr;
+}
+
+oatpp::async::CoroutineStarter Lobby::PendingJoin::onPong(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) {
+  auto peer = getPeer();
+  return peer ? peer->onPong(socket, message) : nullptr;
+}
+
+oatpp::async::CoroutineStarter Lobby::PendingJoin::onClose(const std::shared_ptr<AsyncWebSocket>& socket, v_uint16 code, const oatpp::String& message) {
+  auto peer = getPeer();
+  return peer ? peer->onClose(socket, code, message) : nullptr;
+}
+
+oatpp::async::CoroutineStarter Lobby::PendingJoin::readMessage(const std::shared_ptr<AsyncWebSocket>& socket, v_uint8 opcode, p_char8 data, oatpp::v_io_size size) {
+  auto peer = getPeer();
+  return peer ? peer->readMessage(socket, opcode, data, size) : nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Lobby::CreateRoomCoroutine
+
+class Lobby::CreateRoomCoroutine : public oatpp::async::Coroutine<CreateRoomCoroutine> {
+private:
+  Lobby* m_lobby;
+  std::shared_ptr<PendingJoin> m_pending;
+  std::shared_ptr<std::shared_ptr<const RabinBackend>> m_key;
+public:
+
+  CreateRoomCoroutine(Lobby* lobby, const std::shared_ptr<PendingJoin>& pending)
+    : m_lobby(lobby)
+    , m_pending(pending)
+    , m_key(std::make_shared<std::shared_ptr<const RabinBackend>>())
+  {}
+
+  Action act() override {
+    auto keyPool = m_lobby->m_keyPool;
+    auto key = m_key;
+    return m_lobby->m_computePool->execute([keyPool, key] {
+      *key = keyPool->generate();
+    }).next(yieldTo(&CreateRoomCoroutine::onKey));
+  }
+
+  Action onKey() {
+    if(!*m_key) {
+      OATPP_LOGE("Lobby", "Can't generate key for room '%s'.", m_pending->m_roomName->c_str());
+      m_lobby->completeJoin(m_pending, nullptr);
+      return finish();
+    }
+    m_lobby->completeJoin(m_pending, m_lobby->createRoom(m_pending->m_roomName, *m_key));
+    return finish();
+  }
+
+  Action handleError(Error* error) override {
+    OATPP_LOGE("Lobby", "Can't generate key for room '%s': %s", m_pending->m_roomName->c_str(), error->what());
+    m_lobby->completeJoin(m_pending, nullptr);
+    return finish();
+  }
+
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Lobby
+
+std::shared_ptr<Peer> Lobby::joinRoom(const std::shared_ptr<AsyncWebSocket>& socket, const std::shared_ptr<Room>& room,
+                                      const oatpp::String& nickname, bool rabinEncryption)
+{
+  auto peer = std::make_shared<Peer>(socket, room, nickname, obtainNewPeerId(), rabinEncryption);
+  room->welcomePeer(peer);
+  room->addPeer(peer);
+  room->onboardPeer(peer);
+  return peer;
+}
+
+void Lobby::completeJoin(const std::shared_ptr<PendingJoin>& pending, const std::shared_ptr<Room>& room) {
+
+  std::lock_guard<std::mutex> guard(pending->m_lock);
+
+  if(pending->m_cancelled) { // socket closed while the key was generated
+    if(room && room->isEmpty()) {
+      deleteRoom(room->getName());
     }
+    return;
+  }
 
+  if(room) {
+    pending->m_peer = joinRoom(pending->m_socket, room, pending->m_nickname, pending->m_rabinEncryption);
+  } else {
+    pending->m_socket->getConnection().invalidate();
   }
+  pending->m_socket.reset();
 
 }
 
@@ -80,14 +209,26 @@ void Lobby::onAfterCreate_NonBlocking(const std::shared_ptr<AsyncWebSocket>& soc
 
   auto roomName = params->find("roomName")->second;
   auto nickname = params->find("nickname")->second;
-  auto room = getOrCreateRoom(roomName);
+  auto encryption = params->find("encryption");
+  bool rabinEncryption = encryption != params->end() && encryption->second == "rabin";
 
-  auto peer = std::make_shared<Peer>(socket, room, nickname, obtainNewPeerId());
-  socket->setListener(peer);
+  auto room = getRoom(roomName);
+  if(!room) {
+    auto key = m_keyPool->tryAcquire();
+    if(key) {
+      room = createRoom(roomName, key);
+    }
+  }
 
-  room->welcomePeer(peer);
-  room->addPeer(peer);
-  room->onboardPeer(peer);
+  if(room) {
+    socket->setListener(joinRoom(socket, room, nickname, rabinEncryption));
+    return;
+  }
+
+  /* no ready key - don't stall the executor thread with prime search */
+  auto pending = std::make_shared<PendingJoin>(socket, roomName, nickname, rabinEncryption);
+  socket->setListener(pending);
+  m_asyncExecutor->execute<CreateRoomCoroutine>(this, pending);
 
 }
 
@@ -95,7 +236,22 @@ void Lobby::onBeforeDestroy_NonBlocking(const std::shared_ptr<AsyncWebSocket>& s
 
   ++ m_statistics->EVENT_PEER_DISCONNECTED;
 
-  auto peer = std::static_pointer_cast<Peer>(socket->getListener());
+  std::shared_ptr<Peer> peer;
+  auto listener = socket->getListener();
+  auto pending = std::dynamic_pointer_cast<PendingJoin>(listener);
+  if(pending) {
+    std::lock_guard<std::mutex> guard(pending->m_lock);
+    pending->m_cancelled = true;
+    pending->m_socket.reset();
+    peer = pending->m_peer;
+  } else {
+    peer = std::static_pointer_cast<Peer>(listener);
+  }
+
+  if(!peer) { // left before the room was created
+    return;
+  }
+
   auto room = peer->getRoom();
 
   room->removePeerById(peer->getPeerId());
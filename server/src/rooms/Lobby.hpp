@@ -28,20 +28,90 @@
 #define ASYNC_SERVER_ROOMS_LOBBY_HPP
 
 #include "./Room.hpp"
+#include "utils/ComputePool.hpp"
 #include "utils/Statistics.hpp"
+#include "utils/RabinKeyPool.hpp"
 
 #include "oatpp-websocket/AsyncConnectionHandler.hpp"
 
+#include "oatpp/core/async/Executor.hpp"
+
 #include <unordered_map>
+#include <vector>
 #include <mutex>
 
 class Lobby : public oatpp::websocket::AsyncConnectionHandler::SocketInstanceListener {
+private:
+
+  class CreateRoomCoroutine;
+
+  /**
+   * Socket listener of a peer whose room waits for its key. <br>
+   * Forwards everything to the peer once it joined the room. Until then incoming frames are ignored -
+   * the client sends nothing before it gets `CODE_INFO`.
+   */
+  class PendingJoin : public oatpp::websocket::AsyncWebSocket::Listener {
+    friend Lobby;
+    friend CreateRoomCoroutine;
+  private:
+    std::mutex m_lock;
+    std::shared_ptr<AsyncWebSocket> m_socket;
+    oatpp::String m_roomName;
+    oatpp::String m_nickname;
+    bool m_rabinEncryption;
+    bool m_cancelled;
+    std::shared_ptr<Peer> m_peer;
+  private:
+    std::shared_ptr<Peer> getPeer();
+  public:
+
+    PendingJoin(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& roomName, const oatpp::String& nickname, bool rabinEncryption)
+      : m_socket(socket)
+      , m_roomName(roomName)
+      , m_nickname(nickname)
+      , m_rabinEncryption(rabinEncryption)
+      , m_cancelled(false)
+    {}
+
+    CoroutineStarter onPing(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) override;
+    CoroutineStarter onPong(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) override;
+    CoroutineStarter onClose(const std::shared_ptr<AsyncWebSocket>& socket, v_uint16 code, const oatpp::String& message) override;
+    CoroutineStarter readMessage(const std::shared_ptr<AsyncWebSocket>& socket, v_uint8 opcode, p_char8 data, oatpp::v_io_size size) override;
+
+  };
+
 public:
   std::atomic<v_int64> m_peerIdCounter;
   std::unordered_map<oatpp::String, std::shared_ptr<Room>> m_rooms;
   std::mutex m_roomsMutex;
 private:
   OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+  OATPP_COMPONENT(std::shared_ptr<RabinKeyPool>, m_keyPool);
+  OATPP_COMPONENT(std::shared_ptr<ComputePool>, m_computePool);
+  OATPP_COMPONENT(std::shared_ptr<oatpp::async::Executor>, m_asyncExecutor);
+private:
+
+  /**
+   * Create peer and join it to the room.
+   * @return - peer to be set as the socket listener.
+   */
+  std::shared_ptr<Peer> joinRoom(const std::shared_ptr<AsyncWebSocket>& socket, const std::shared_ptr<Room>& room,
+                                 const oatpp::String& nickname, bool rabinEncryption);
+
+  /**
+   * Join pending peer to its room, once the room has its key.
+   * @param pending
+   * @param room - `nullptr` if the key couldn't be generated. The peer is disconnected then.
+   */
+  void completeJoin(const std::shared_ptr<PendingJoin>& pending, const std::shared_ptr<Room>& room);
+
+  /**
+   * Copy of the room list. Loops iterate over it without holding `m_roomsMutex`,
+   * so signing or pinging never blocks room creation and lookup.
+   * @return
+   */
+  std::vector<std::shared_ptr<Room>> getRoomsSnapshot();
+
 public:
 
   Lobby()
@@ -55,11 +125,12 @@ public:
   v_int64 obtainNewPeerId();
 
   /**
-   * Get room by name or create new one if not exists.
+   * Create room with the given key, or get the room if it was created meanwhile - the key goes back to the pool then.
    * @param roomName
+   * @param key
    * @return
    */
-  std::shared_ptr<Room> getOrCreateRoom(const oatpp::String& roomName);
+  std::shared_ptr<Room> createRoom(const oatpp::String& roomName, const std::shared_ptr<const RabinBackend>& key);
 
   /**
    * Get room by name.
@@ -80,10 +151,19 @@ public:
    */
   void runPingLoop(const std::chrono::duration<v_int64, std::micro>& interval = std::chrono::minutes(1));
 
+  /**
+   * Room housekeeping in the loop. Each time `interval`:
+   * send aggregated typing messages and sign pending message chains of all rooms.
+   * @param interval
+   */
+  void runRoomTickLoop(const std::chrono::duration<v_int64, std::micro>& interval);
+
 public:
 
   /**
-   *  Called when socket is created
+   *  Called when socket is created. <br>
+   *  Runs on an executor thread, so it never generates a room key inline: if the key pool is empty,
+   *  the key is generated on the `ComputePool` and the peer joins the room when it is ready.
    */
   void onAfterCreate_NonBlocking(const std::shared_ptr<AsyncWebSocket>& socket, const std::shared_ptr<const ParameterMap>& params) override;
 
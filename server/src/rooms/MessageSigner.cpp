@@ -0,0 +1,132 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "MessageSigner.hpp"
+
+#include "oatpp/core/base/Environment.hpp"
+
+#include <openssl/evp.h>
+
+#include <stdexcept>
+
+constexpr v_buff_size MessageSigner::CHAIN_SIZE;
+
+namespace {
+
+void putInt64(std::vector<uint8_t>& buffer, v_int64 value) {
+  for(int shift = 56; shift >= 0; shift -= 8) {
+    buffer.push_back((uint8_t) ((v_uint64) value >> shift));
+  }
+}
+
+void sha256(const void* data, size_t size, uint8_t* out) {
+  if(!EVP_Digest(data, size, out, nullptr, EVP_sha256(), nullptr)) {
+    throw std::runtime_error("[MessageSigner]: Error. EVP_Digest failed.");
+  }
+}
+
+}
+
+oatpp::String MessageSigner::toHex(const uint8_t* data, v_buff_size size) {
+  static const char* ALPHABET = "0123456789abcdef";
+  std::string result((size_t) size * 2, '0');
+  for(v_buff_size i = 0; i < size; i ++) {
+    result[i * 2] = ALPHABET[data[i] >> 4];
+    result[i * 2 + 1] = ALPHABET[data[i] & 15];
+  }
+  return oatpp::String(std::move(result));
+}
+
+void MessageSigner::chainStep(const uint8_t* prev, const oatpp::Object<MessageDto>& message, uint8_t* next) {
+  std::vector<uint8_t> buffer(prev, prev + CHAIN_SIZE);
+  putInt64(buffer, message->seq ? *message->seq : 0);
+  putInt64(buffer, message->code ? static_cast<v_int64>(*message->code) : 0);
+  putInt64(buffer, message->peerId ? *message->peerId : 0);
+  putInt64(buffer, message->peerName ? (v_int64) message->peerName->size() : 0);
+  if(message->peerName) {
+    buffer.insert(buffer.end(), message->peerName->begin(), message->peerName->end());
+  }
+  putInt64(buffer, message->timestamp ? *message->timestamp : 0);
+  if(message->message) {
+    buffer.insert(buffer.end(), message->message->begin(), message->message->end());
+  }
+  sha256(buffer.data(), buffer.size(), next);
+}
+
+MessageSigner::MessageSigner(const std::shared_ptr<const RabinWilliamsKey>& key,
+                             const oatpp::String& roomName,
+                             v_int64 signEvery,
+                             v_int64 signIntervalMicro)
+  : m_key(key)
+  , m_signEvery(signEvery > 0 ? signEvery : 1)
+  , m_signIntervalMicro(signIntervalMicro)
+  , m_seq(0)
+  , m_lastSignedSeq(0)
+  , m_lastSignedTime(0)
+  , m_signature(key->getSignatureSize())
+{
+  sha256(roomName->data(), roomName->size(), m_chain);
+}
+
+bool MessageSigner::sign(const oatpp::Object<MessageDto>& message) {
+
+  message->seq = ++ m_seq;
+  chainStep(m_chain, message, m_chain);
+  message->chain = toHex(m_chain, CHAIN_SIZE);
+
+  v_int64 now = message->timestamp ? *message->timestamp : oatpp::base::Environment::getMicroTickCount();
+  if(m_seq - m_lastSignedSeq < m_signEvery && now - m_lastSignedTime < m_signIntervalMicro) {
+    return false;
+  }
+
+  m_key->sign(m_chain, CHAIN_SIZE, m_signature.data());
+  message->signature = toHex(m_signature.data(), (v_buff_size) m_signature.size());
+  m_lastSignedSeq = m_seq;
+  m_lastSignedTime = now;
+
+  return true;
+
+}
+
+oatpp::Object<MessageDto> MessageSigner::signPending(v_int64 now) {
+
+  if(m_seq == m_lastSignedSeq || now - m_lastSignedTime < m_signIntervalMicro) {
+    return nullptr;
+  }
+
+  m_key->sign(m_chain, CHAIN_SIZE, m_signature.data());
+  m_lastSignedSeq = m_seq;
+  m_lastSignedTime = now;
+
+  auto message = MessageDto::createShared();
+  message->code = MessageCodes::CODE_CHAIN_SIGNATURE;
+  message->timestamp = now;
+  message->seq = m_seq;
+  message->chain = toHex(m_chain, CHAIN_SIZE);
+  message->signature = toHex(m_signature.data(), (v_buff_size) m_signature.size());
+  return message;
+
+}
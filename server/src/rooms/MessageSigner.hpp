@@ -0,0 +1,109 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef ASYNC_SERVER_ROOMS_MESSAGESIGNER_HPP
+#define ASYNC_SERVER_ROOMS_MESSAGESIGNER_HPP
+
+#include "dto/DTOs.hpp"
+#include "rabin/RabinWilliamsKey.hpp"
+
+#include <vector>
+
+/**
+ * Per-room hash chain of chat messages, signed with the server Rabin-Williams key. <br>
+ * Each message gets `seq` and
+ * `chain = SHA256(prevChain || seq || code || peerId || len(peerName) || peerName || timestamp || message)`,
+ * numbers are 8-byte big-endian, the chain starts from `SHA256(roomName)`. <br>
+ * A chain head is signed if `signEvery` messages passed since the last signature
+ * or the last signature is older than `signInterval` - at low message rates every message is signed,
+ * at high rates one signature covers a batch. Anyone with the public modulus verifies a batch
+ * by recomputing the chain and squaring the signature once. <br>
+ * If the room goes quiet with unsigned messages, `signPending()` signs the head from the room tick
+ * and the signature goes out as a separate `CODE_CHAIN_SIGNATURE` message. <br>
+ * Not thread-safe - the room serializes calls.
+ */
+class MessageSigner {
+public:
+  static constexpr v_buff_size CHAIN_SIZE = 32;
+private:
+  std::shared_ptr<const RabinWilliamsKey> m_key;
+  v_int64 m_signEvery;
+  v_int64 m_signIntervalMicro;
+  v_int64 m_seq;
+  v_int64 m_lastSignedSeq;
+  v_int64 m_lastSignedTime;
+  uint8_t m_chain[CHAIN_SIZE];
+  std::vector<uint8_t> m_signature;
+public:
+
+  /**
+   * Hex-encode bytes - lowercase.
+   * @param data
+   * @param size
+   * @return
+   */
+  static oatpp::String toHex(const uint8_t* data, v_buff_size size);
+
+  /**
+   * Next link of the chain.
+   * @param prev - previous link, `CHAIN_SIZE` bytes.
+   * @param message - message with `seq`, `code`, `peerId`, `peerName`, `timestamp` and `message` set.
+   * @param next - output, `CHAIN_SIZE` bytes.
+   */
+  static void chainStep(const uint8_t* prev, const oatpp::Object<MessageDto>& message, uint8_t* next);
+
+public:
+
+  /**
+   * Constructor.
+   * @param key - server signing key.
+   * @param roomName - name of the room, seeds the chain.
+   * @param signEvery - max number of messages covered by one signature.
+   * @param signIntervalMicro - max age of the last signature in microseconds.
+   */
+  MessageSigner(const std::shared_ptr<const RabinWilliamsKey>& key,
+                const oatpp::String& roomName,
+                v_int64 signEvery,
+                v_int64 signIntervalMicro);
+
+  /**
+   * Append message to the chain - set `seq` and `chain` fields, and `signature` if it is due.
+   * @param message
+   * @return - `true` if the message was signed.
+   */
+  bool sign(const oatpp::Object<MessageDto>& message);
+
+  /**
+   * Sign the chain head if it has unsigned messages and the last signature is older than `signInterval`.
+   * @param now - current time in microseconds.
+   * @return - `CODE_CHAIN_SIGNATURE` message with `seq`, `chain` and `signature` of the head,
+   * or `nullptr` if nothing is due.
+   */
+  oatpp::Object<MessageDto> signPending(v_int64 now);
+
+};
+
+#endif //ASYNC_SERVER_ROOMS_MESSAGESIGNER_HPP
@@ -0,0 +1,271 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "Outbox.hpp"
+
+constexpr v_buff_size Outbox::COALESCE_FRAME_SIZE;
+constexpr v_buff_size Outbox::COALESCE_BUFFER_SIZE;
+
+class Outbox::WriterCoroutine : public oatpp::async::Coroutine<WriterCoroutine> {
+private:
+  std::shared_ptr<Outbox> m_outbox;
+  std::shared_ptr<AsyncWebSocket> m_socket;
+  oatpp::String m_frame;
+  std::string m_buffer;
+public:
+
+  WriterCoroutine(const std::shared_ptr<Outbox>& outbox, const std::shared_ptr<AsyncWebSocket>& socket)
+    : m_outbox(outbox)
+    , m_socket(socket)
+  {
+    m_buffer.reserve(COALESCE_BUFFER_SIZE);
+  }
+
+  Action act() override {
+
+    std::lock_guard<std::mutex> guard(m_outbox->m_lock);
+
+    if(!m_outbox->m_open) {
+      if(m_outbox->m_overflowed) {
+        m_socket->getConnection().invalidate(); // peer can't keep up - drop it, the socket listener cleans up
+      }
+      return finish();
+    }
+
+    auto& outbox = *m_outbox;
+    if(outbox.isEmpty()) {
+      return Action::createWaitListAction(&outbox.m_waitList);
+    }
+
+    /* single or large frame - send as is, no copy */
+    if(outbox.getDepthLocked() == 1 || outbox.front()->size() > COALESCE_FRAME_SIZE) {
+      m_frame = outbox.front();
+      outbox.popFront();
+      -- outbox.m_statistics->PEER_OUTBOX_FRAMES;
+      return oatpp::async::synchronize(&outbox.m_writeLock, m_socket->sendOneFrameTextAsync(m_frame))
+        .next(yieldTo(&WriterCoroutine::act));
+    }
+
+    /* run of small frames - pack into one buffer, one socket write */
+    m_buffer.clear();
+    v_uint64 count = 0;
+    while(!outbox.isEmpty() && outbox.front()->size() <= COALESCE_FRAME_SIZE &&
+          (v_buff_size) (m_buffer.size() + outbox.front()->size()) + 4 <= COALESCE_BUFFER_SIZE)
+    {
+      packFrame(m_buffer, outbox.front());
+      outbox.popFront();
+      ++ count;
+    }
+
+    m_outbox->m_statistics->PEER_OUTBOX_FRAMES -= count;
+    m_outbox->m_statistics->EVENT_SOCKET_WRITES_SAVED += count - 1;
+
+    return oatpp::async::synchronize(&m_outbox->m_writeLock,
+                                     m_socket->getConnection().object->writeExactSizeDataAsync(m_buffer.data(), (v_buff_size) m_buffer.size()))
+      .next(yieldTo(&WriterCoroutine::act));
+
+  }
+
+  Action handleError(Error* error) override {
+    m_outbox->close();
+    return error;
+  }
+
+};
+
+Outbox::Outbox(const std::shared_ptr<AsyncWebSocket>& socket)
+  : m_socket(socket)
+  , m_open(true)
+  , m_overflowed(false)
+  , m_writerStarted(false)
+{
+  m_waitList.setListener(this);
+}
+
+void Outbox::packFrame(std::string& buffer, const oatpp::String& payload) {
+
+  /* RFC 6455 server frame: FIN + text opcode, unmasked */
+  v_uint64 size = payload->size();
+  buffer.push_back((char) 0x81);
+  if(size < 126) {
+    buffer.push_back((char) size);
+  } else if(size <= 0xFFFF) {
+    buffer.push_back((char) 126);
+    buffer.push_back((char) (size >> 8));
+    buffer.push_back((char) (size & 0xFF));
+  } else {
+    buffer.push_back((char) 127);
+    for(v_int32 i = 7; i >= 0; i --) {
+      buffer.push_back((char) ((size >> (8 * i)) & 0xFF));
+    }
+  }
+  buffer.append(*payload);
+
+}
+
+bool Outbox::isEmpty() const {
+  return m_frames.empty() && m_ephemeralOrder.empty();
+}
+
+v_uint64 Outbox::getDepthLocked() const {
+  return m_frames.size() + m_ephemeralOrder.size();
+}
+
+const oatpp::String& Outbox::front() const {
+  if(!m_frames.empty()) {
+    return m_frames.front();
+  }
+  return m_ephemeralFrames.at(m_ephemeralOrder.front());
+}
+
+void Outbox::popFront() {
+  if(!m_frames.empty()) {
+    m_frames.pop_front();
+    return;
+  }
+  m_ephemeralFrames.erase(m_ephemeralOrder.front());
+  m_ephemeralOrder.pop_front();
+}
+
+void Outbox::wakeWriter(const std::shared_ptr<AsyncWebSocket>& startWriterOn) {
+  if(startWriterOn) {
+    m_asyncExecutor->execute<WriterCoroutine>(shared_from_this(), startWriterOn);
+  } else {
+    m_waitList.notifyAll();
+  }
+}
+
+void Outbox::push(const oatpp::String& frame) {
+
+  std::shared_ptr<AsyncWebSocket> startWriterOn;
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(!m_open) {
+      return;
+    }
+
+    if(m_frames.size() >= *m_appConfig->maxPeerQueueFrames) {
+      ++ m_statistics->EVENT_PEER_OUTBOX_OVERFLOW;
+      m_overflowed = true;
+      closeLocked();
+    } else {
+
+      m_frames.push_back(frame);
+      ++ m_statistics->PEER_OUTBOX_FRAMES;
+
+      v_uint64 depth = getDepthLocked();
+      v_uint64 maxDepth = m_statistics->PEER_OUTBOX_MAX_DEPTH;
+      while(depth > maxDepth && !m_statistics->PEER_OUTBOX_MAX_DEPTH.compare_exchange_weak(maxDepth, depth)) {}
+
+      if(!m_writerStarted) {
+        m_writerStarted = true;
+        startWriterOn = m_socket;
+      }
+
+    }
+  }
+
+  wakeWriter(startWriterOn); // on overflow - wakes the writer to drop the connection
+
+}
+
+void Outbox::pushEphemeral(v_int64 key, const oatpp::String& frame) {
+
+  std::shared_ptr<AsyncWebSocket> startWriterOn;
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(!m_open) {
+      return;
+    }
+
+    auto it = m_ephemeralFrames.find(key);
+    if(it != m_ephemeralFrames.end()) {
+      it->second = frame; // keep position in the lane, send the latest state
+      ++ m_statistics->EVENT_EPHEMERAL_DROPPED;
+      return;
+    }
+
+    m_ephemeralFrames[key] = frame;
+    m_ephemeralOrder.push_back(key);
+    ++ m_statistics->PEER_OUTBOX_FRAMES;
+
+    if(!m_writerStarted) {
+      m_writerStarted = true;
+      startWriterOn = m_socket;
+    }
+  }
+
+  wakeWriter(startWriterOn);
+
+}
+
+void Outbox::closeLocked() {
+  m_open = false;
+  m_statistics->PEER_OUTBOX_FRAMES -= getDepthLocked();
+  m_frames.clear();
+  m_ephemeralOrder.clear();
+  m_ephemeralFrames.clear();
+  m_socket.reset();
+}
+
+void Outbox::close() {
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    if(!m_open) {
+      return;
+    }
+    closeLocked();
+  }
+
+  m_waitList.notifyAll();
+
+}
+
+bool Outbox::isOverflowed() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_overflowed;
+}
+
+v_uint32 Outbox::getDepth() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return (v_uint32) getDepthLocked();
+}
+
+oatpp::async::Lock* Outbox::getWriteLock() {
+  return &m_writeLock;
+}
+
+void Outbox::onNewItem(oatpp::async::CoroutineWaitList& list) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  if(!m_open || !isEmpty()) {
+    list.notifyAll();
+  }
+}
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef ASYNC_SERVER_ROOMS_OUTBOX_HPP
+#define ASYNC_SERVER_ROOMS_OUTBOX_HPP
+
+#include "dto/Config.hpp"
+#include "utils/Statistics.hpp"
+
+#include "oatpp-websocket/AsyncWebSocket.hpp"
+
+#include "oatpp/core/async/CoroutineWaitList.hpp"
+#include "oatpp/core/async/Executor.hpp"
+#include "oatpp/core/async/Lock.hpp"
+#include "oatpp/core/macro/component.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * Bounded queue of outgoing text frames of one peer, drained by a single writer coroutine. <br>
+ * Frames go to one of two lanes. The reliable lane (chat, files, presence) is never dropped and is always written first.
+ * The ephemeral lane (typing indicators) is written only when the reliable lane is empty and keeps the latest frame per key (sender) -
+ * a newer frame replaces an unsent older one. <br>
+ * The writer is started on the first frame and lives until the outbox is closed, waiting on a wait list while the queue is empty.
+ * Runs of small frames are packed into one buffer and written to the socket with one write.
+ */
+class Outbox : public oatpp::async::CoroutineWaitList::Listener, public std::enable_shared_from_this<Outbox> {
+public:
+  typedef oatpp::websocket::AsyncWebSocket AsyncWebSocket;
+public:
+
+  /**
+   * Frames up to this size are coalesced with neighbours.
+   */
+  static constexpr v_buff_size COALESCE_FRAME_SIZE = 4 * 1024;
+
+  /**
+   * Max size of one coalesced write.
+   */
+  static constexpr v_buff_size COALESCE_BUFFER_SIZE = 64 * 1024;
+
+private:
+  class WriterCoroutine; // FWD
+private:
+  std::shared_ptr<AsyncWebSocket> m_socket;
+  oatpp::async::Lock m_writeLock;
+  std::mutex m_lock;
+  std::deque<oatpp::String> m_frames;
+  std::deque<v_int64> m_ephemeralOrder;
+  std::unordered_map<v_int64, oatpp::String> m_ephemeralFrames;
+  bool m_open;
+  bool m_overflowed;
+  bool m_writerStarted;
+  oatpp::async::CoroutineWaitList m_waitList;
+private:
+  OATPP_COMPONENT(std::shared_ptr<oatpp::async::Executor>, m_asyncExecutor);
+  OATPP_COMPONENT(oatpp::Object<ConfigDto>, m_appConfig);
+  OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+private:
+  static void packFrame(std::string& buffer, const oatpp::String& payload);
+private:
+  /* call with m_lock held */
+  bool isEmpty() const;
+  v_uint64 getDepthLocked() const;
+  const oatpp::String& front() const;
+  void popFront();
+  void closeLocked();
+  void wakeWriter(const std::shared_ptr<AsyncWebSocket>& startWriterOn);
+public:
+
+  /**
+   * Constructor.
+   * @param socket
+   */
+  Outbox(const std::shared_ptr<AsyncWebSocket>& socket);
+
+  /**
+   * Queue text frame. Frames pushed to a closed outbox are dropped silently. <br>
+   * If the queue is full (`ConfigDto::maxPeerQueueFrames`) the outbox is closed as overflowed.
+   * The caller never touches the socket - the writer (or the ping loop, see `isOverflowed()`) drops the connection.
+   * @param frame
+   */
+  void push(const oatpp::String& frame);
+
+  /**
+   * Queue frame to the ephemeral lane. Replaces unsent frame with the same key.
+   * @param key - sender id.
+   * @param frame
+   */
+  void pushEphemeral(v_int64 key, const oatpp::String& frame);
+
+  /**
+   * Drop queued frames and stop the writer.
+   */
+  void close();
+
+  /**
+   * The outbox was closed because the peer couldn't keep up.
+   * @return
+   */
+  bool isOverflowed();
+
+  /**
+   * Number of queued frames in both lanes.
+   * @return
+   */
+  v_uint32 getDepth();
+
+  /**
+   * Lock for other writes to the socket (pings, pongs, errors), so they are not interleaved with the writer.
+   * @return
+   */
+  oatpp::async::Lock* getWriteLock();
+
+  /**
+   * Wake the writer if it starts waiting when there is something to do.
+   */
+  void onNewItem(oatpp::async::CoroutineWaitList& list) override;
+
+};
+
+#endif //ASYNC_SERVER_ROOMS_OUTBOX_HPP
@@ -31,32 +31,23 @@
 #include "oatpp/encoding/Base64.hpp"
 
 void Peer::sendMessageAsync(const oatpp::Object<MessageDto>& message) {
+  sendFrameAsync(m_objectMapper->writeToString(message));
+}
 
-  class SendMessageCoroutine : public oatpp::async::Coroutine<SendMessageCoroutine> {
-  private:
-    oatpp::async::Lock* m_lock;
-    std::shared_ptr<AsyncWebSocket> m_websocket;
-    oatpp::String m_message;
-  public:
-
-    SendMessageCoroutine(oatpp::async::Lock* lock,
-                         const std::shared_ptr<AsyncWebSocket>& websocket,
-                         const oatpp::String& message)
-      : m_lock(lock)
-      , m_websocket(websocket)
-      , m_message(message)
-    {}
-
-    Action act() override {
-      return oatpp::async::synchronize(m_lock, m_websocket->sendOneFrameTextAsync(m_message)).next(finish());
-    }
+void Peer::sendFrameAsync(const oatpp::String& frame) {
+  m_outbox->push(frame);
+}
 
-  };
+void Peer::sendEphemeralFrameAsync(const oatpp::String& frame, v_int64 senderId) {
+  m_outbox->pushEphemeral(senderId, frame);
+}
 
-  if(m_socket) {
-    m_asyncExecutor->execute<SendMessageCoroutine>(&m_writeLock, m_socket, m_objectMapper->writeToString(message));
-  }
+bool Peer::isOutboxOverflowed() {
+  return m_outbox->isOverflowed();
+}
 
+v_uint32 Peer::getOutboxDepth() {
+  return m_outbox->getDepth();
 }
 
 bool Peer::sendPingAsync() {
@@ -91,8 +82,9 @@ bool Peer::sendPingAsync() {
 
   ++ m_pingPoingCounter;
 
-  if(m_socket && m_pingPoingCounter == 1) {
-    m_asyncExecutor->execute<SendPingCoroutine>(&m_writeLock, m_socket);
+  auto socket = std::atomic_load(&m_socket);
+  if(socket && m_pingPoingCounter == 1) {
+    m_asyncExecutor->execute<SendPingCoroutine>(m_outbox->getWriteLock(), socket);
     return true;
   }
 
@@ -136,7 +128,12 @@ oatpp::async::CoroutineStarter Peer::onApiError(const oatpp::String& errorMessag
   message->code = MessageCodes::CODE_API_ERROR;
   message->message = errorMessage;
 
-  return SendErrorCoroutine::start(&m_writeLock, m_socket, m_objectMapper->writeToString(message));
+  auto socket = std::atomic_load(&m_socket);
+  if(!socket) {
+    return nullptr; // socket is already invalidated - the connection is going down anyway
+  }
+
+  return SendErrorCoroutine::start(m_outbox->getWriteLock(), socket, m_objectMapper->writeToString(message));
 
 }
 
@@ -227,24 +224,130 @@ oatpp::async::CoroutineStarter Peer::handleFileChunkMessage(const oatpp::Object<
 
 }
 
+oatpp::String Peer::decryptText(const oatpp::String& text) {
+
+  if(!text) {
+    return nullptr;
+  }
+
+  try {
+    auto frame = oatpp::encoding::Base64::decode(text);
+    return m_room->getCodec().decode(frame->data(), frame->size());
+  } catch (const std::runtime_error& e) {
+    return nullptr;
+  }
+
+}
+
+oatpp::async::CoroutineStarter Peer::handleEncryptedMessage(const oatpp::Object<MessageDto>& message) {
+
+  class DecryptCoroutine : public oatpp::async::Coroutine<DecryptCoroutine> {
+  private:
+    std::shared_ptr<Peer> m_peer;
+    oatpp::Object<MessageDto> m_message;
+    std::shared_ptr<oatpp::String> m_plaintext;
+    bool m_inPool;
+    v_int32 m_attempts;
+    v_int64 m_retryTime;
+  public:
+
+    DecryptCoroutine(const std::shared_ptr<Peer>& peer, const oatpp::Object<MessageDto>& message)
+      : m_peer(peer)
+      , m_message(message)
+      , m_plaintext(std::make_shared<oatpp::String>())
+      , m_inPool(false)
+      , m_attempts(0)
+      , m_retryTime(0)
+    {}
+
+    Action act() override {
+      auto peer = m_peer;
+      oatpp::String text = m_message->message;
+      auto plaintext = m_plaintext;
+      m_inPool = true;
+      return m_peer->m_computePool->execute([peer, text, plaintext] {
+        *plaintext = peer->decryptText(text);
+      }).next(yieldTo(&DecryptCoroutine::onDecrypted));
+    }
+
+    Action onDecrypted() {
+      m_inPool = false;
+      if(!*m_plaintext) {
+        return m_peer->onApiError("Can't decrypt message.").next(finish());
+      }
+      m_message->message = *m_plaintext;
+      m_peer->m_room->publishMessage(m_message);
+      ++ m_peer->m_statistics->EVENT_PEER_SEND_MESSAGE;
+      return finish();
+    }
+
+    Action onRetry() {
+      if(oatpp::base::Environment::getMicroTickCount() < m_retryTime) {
+        return Action::createWaitRepeatAction(m_retryTime);
+      }
+      return yieldTo(&DecryptCoroutine::act);
+    }
+
+    /*
+     * Error while in the pool is a rejected job - most likely the compute pool queue is full.
+     * Back off and retry (the socket reader waits meanwhile), then tell the client instead of dropping the socket silently.
+     */
+    Action handleError(Error* error) override {
+      constexpr v_int32 maxAttempts = 4;
+      constexpr v_int64 retryDelayMicro = 50 * 1000;
+      if(!m_inPool) {
+        return error;
+      }
+      m_inPool = false;
+      if(++ m_attempts < maxAttempts) {
+        m_retryTime = oatpp::base::Environment::getMicroTickCount() + retryDelayMicro * m_attempts;
+        return yieldTo(&DecryptCoroutine::onRetry);
+      }
+      OATPP_LOGW("Peer", "Can't decrypt message of peer %lld after %d attempts: %s",
+                 (long long) m_peer->m_peerId, m_attempts, error->what());
+      return m_peer->onApiError("Server is busy.").next(finish());
+    }
+
+  };
+
+  return DecryptCoroutine::start(shared_from_this(), message);
+
+}
+
 oatpp::async::CoroutineStarter Peer::handleMessage(const oatpp::Object<MessageDto>& message) {
 
   if(!message->code) {
     return onApiError("No message code provided.");
   }
 
+  v_int64 now = oatpp::base::Environment::getMicroTickCount();
+
   switch(*message->code) {
 
     case MessageCodes::CODE_PEER_MESSAGE:
-      m_room->addHistoryMessage(message);
-      m_room->sendMessageAsync(message);
+      if(!m_chatBucket.tryTake(now)) {
+        ++ m_statistics->EVENT_PEER_RATE_LIMITED;
+        return onApiError("Too many messages.");
+      }
+      if(m_rabinEncryption) {
+        return handleEncryptedMessage(message);
+      }
+      m_room->publishMessage(message);
       ++ m_statistics->EVENT_PEER_SEND_MESSAGE;
       break;
 
     case MessageCodes::CODE_PEER_IS_TYPING:
-      m_room->sendMessageAsync(message); break;
+      if(!m_typingBucket.tryTake(now)) {
+        ++ m_statistics->EVENT_PEER_RATE_LIMITED; // ephemeral - just drop
+        break;
+      }
+      m_room->addTypingPeer(m_peerId, m_nickname); break;
 
     case MessageCodes::CODE_FILE_SHARE:
+      if(!m_fileShareBucket.tryTake(now)) {
+        ++ m_statistics->EVENT_PEER_RATE_LIMITED;
+        return onApiError("Too many files shared.");
+      }
       return handleFilesMessage(message);
 
     case MessageCodes::CODE_FILE_CHUNK_DATA:
@@ -280,14 +383,16 @@ const std::list<std::shared_ptr<File>>& Peer::getFiles() {
 }
 
 void Peer::invalidateSocket() {
-  if(m_socket) {
-    m_socket->getConnection().invalidate();
+  /* exchange - only one of the concurrent callers (ping loop, onBeforeDestroy, error paths) invalidates the connection */
+  auto socket = std::atomic_exchange(&m_socket, std::shared_ptr<AsyncWebSocket>());
+  if(socket) {
+    socket->getConnection().invalidate();
   }
-  m_socket.reset();
+  m_outbox->close();
 }
 
 oatpp::async::CoroutineStarter Peer::onPing(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) {
-  return oatpp::async::synchronize(&m_writeLock, socket->sendPongAsync(message));
+  return oatpp::async::synchronize(m_outbox->getWriteLock(), socket->sendPongAsync(message));
 }
 
 oatpp::async::CoroutineStarter Peer::onPong(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) {
@@ -299,6 +404,72 @@ oatpp::async::CoroutineStarter Peer::onClose(const std::shared_ptr<AsyncWebSocke
   return nullptr; // do nothing
 }
 
+oatpp::async::CoroutineStarter Peer::parseMessage(const oatpp::String& text) {
+
+  /*
+   * Holds the message until the peer is back within its rate limit.
+   * The socket reader waits for this coroutine, so the peer's next frames are not read meanwhile.
+   */
+  class DeferCoroutine : public oatpp::async::Coroutine<DeferCoroutine> {
+  private:
+    Peer* m_peer;
+    oatpp::Object<MessageDto> m_message;
+    v_int64 m_wakeupTime;
+  public:
+
+    DeferCoroutine(Peer* peer, const oatpp::Object<MessageDto>& message, v_int64 delayMicro)
+      : m_peer(peer)
+      , m_message(message)
+      , m_wakeupTime(oatpp::base::Environment::getMicroTickCount() + delayMicro)
+    {}
+
+    Action act() override {
+      if(oatpp::base::Environment::getMicroTickCount() < m_wakeupTime) {
+        return Action::createWaitRepeatAction(m_wakeupTime);
+      }
+      return m_peer->handleMessage(m_message).next(finish());
+    }
+
+  };
+
+  oatpp::Object<MessageDto> message;
+
+  try {
+    message = m_objectMapper->readFromString<oatpp::Object<MessageDto>>(text);
+  } catch (const std::runtime_error& e) {
+    return onApiError("Can't parse message");
+  }
+
+  v_int64 now = oatpp::base::Environment::getMicroTickCount();
+
+  message->peerName = m_nickname;
+  message->peerId = m_peerId;
+  message->timestamp = now;
+
+  /* chain and signature fields are set by the server only */
+  message->seq = nullptr;
+  message->chain = nullptr;
+  message->signature = nullptr;
+  message->signingKey = nullptr;
+  message->roomKey = nullptr;
+
+  /* file chunks are requested by the server - limit their bytes, not their count */
+  v_int64 delay;
+  if(message->code && *message->code == MessageCodes::CODE_FILE_CHUNK_DATA) {
+    delay = m_fileChunkBucket.take(now, (v_uint32) text->size());
+  } else {
+    delay = m_messageBucket.take(now);
+  }
+
+  if(delay > 0) {
+    ++ m_statistics->EVENT_PEER_RATE_DEFERRED;
+    return DeferCoroutine::start(this, message, delay);
+  }
+
+  return handleMessage(message);
+
+}
+
 oatpp::async::CoroutineStarter Peer::readMessage(const std::shared_ptr<AsyncWebSocket>& socket, v_uint8 opcode, p_char8 data, oatpp::v_io_size size) {
 
   if(m_messageBuffer.getCurrentPosition() + size >  m_appConfig->maxMessageSizeBytes) {
@@ -310,19 +481,7 @@ oatpp::async::CoroutineStarter Peer::readMessage(const std::shared_ptr<AsyncWebS
     auto wholeMessage = m_messageBuffer.toString();
     m_messageBuffer.setCurrentPosition(0);
 
-    oatpp::Object<MessageDto> message;
-
-    try {
-      message = m_objectMapper->readFromString<oatpp::Object<MessageDto>>(wholeMessage);
-    } catch (const std::runtime_error& e) {
-      return onApiError("Can't parse message");
-    }
-
-    message->peerName = m_nickname;
-    message->peerId = m_peerId;
-    message->timestamp = oatpp::base::Environment::getMicroTickCount();
-
-    return handleMessage(message);
+    return parseMessage(wholeMessage);
 
   } else if(size > 0) { // message frame received
     m_messageBuffer.writeSimple(data, size);
@@ -30,7 +30,10 @@
 #include "dto/DTOs.hpp"
 #include "dto/Config.hpp"
 #include "rooms/File.hpp"
+#include "rooms/Outbox.hpp"
+#include "utils/ComputePool.hpp"
 #include "utils/Statistics.hpp"
+#include "utils/TokenBucket.hpp"
 
 #include "oatpp-websocket/AsyncWebSocket.hpp"
 
@@ -43,7 +46,7 @@
 
 class Room; // FWD
 
-class Peer : public oatpp::websocket::AsyncWebSocket::Listener {
+class Peer : public oatpp::websocket::AsyncWebSocket::Listener, public std::enable_shared_from_this<Peer> {
 private:
 
   /**
@@ -52,15 +55,16 @@ private:
   oatpp::data::stream::BufferOutputStream m_messageBuffer;
 
   /**
-   * Lock for synchronization of writes to the web socket.
+   * Queue of outgoing frames with the socket writer. Also owns the lock for other writes to the web socket.
    */
-  oatpp::async::Lock m_writeLock;
+  std::shared_ptr<Outbox> m_outbox;
 
 private:
-  std::shared_ptr<AsyncWebSocket> m_socket;
+  std::shared_ptr<AsyncWebSocket> m_socket; // read/cleared from broadcast, ping and socket threads - std::atomic_load/std::atomic_exchange only
   std::shared_ptr<Room> m_room;
   oatpp::String m_nickname;
   v_int64 m_peerId;
+  bool m_rabinEncryption;
 private:
   std::atomic<v_int32> m_pingPoingCounter;
   std::list<std::shared_ptr<File>> m_files;
@@ -72,6 +76,20 @@ private:
   OATPP_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, m_objectMapper);
   OATPP_COMPONENT(oatpp::Object<ConfigDto>, m_appConfig);
   OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+  OATPP_COMPONENT(std::shared_ptr<ComputePool>, m_computePool);
+
+private:
+
+  /*
+   * Inbound rate limits (see `ConfigDto`). Used by the socket reader only.
+   * Declared after the injected components - initialized from `m_appConfig`.
+   */
+
+  TokenBucket m_messageBucket;
+  TokenBucket m_fileChunkBucket;
+  TokenBucket m_chatBucket;
+  TokenBucket m_fileShareBucket;
+  TokenBucket m_typingBucket;
 
 private:
 
@@ -83,19 +101,52 @@ private:
   oatpp::async::CoroutineStarter handleFilesMessage(const oatpp::Object<MessageDto>& message);
   oatpp::async::CoroutineStarter handleFileChunkMessage(const oatpp::Object<MessageDto>& message);
 
+  /**
+   * Decrypt chat message on the compute pool and publish it to the room.
+   * @param message
+   * @return
+   */
+  oatpp::async::CoroutineStarter handleEncryptedMessage(const oatpp::Object<MessageDto>& message);
+
   oatpp::async::CoroutineStarter handleMessage(const oatpp::Object<MessageDto>& message);
 
+  /**
+   * Parse complete message received from the socket and handle it. <br>
+   * The message is handled once the peer is within its inbound rate limit - `CODE_FILE_CHUNK_DATA` is counted
+   * in bytes, everything else in messages.
+   * @param text - serialized `MessageDto`.
+   * @return
+   */
+  oatpp::async::CoroutineStarter parseMessage(const oatpp::String& text);
+
+  /**
+   * Decrypt base64 Rabin frame (see `RabinCodec`) with the room key. <br>
+   * The plaintext is published to the room, sender included, so only roots passing the codec redundancy check
+   * are returned - publishing any other root would leak the room key.
+   * @param text
+   * @return - plaintext or `nullptr` if the frame is invalid.
+   */
+  oatpp::String decryptText(const oatpp::String& text);
+
 public:
 
   Peer(const std::shared_ptr<AsyncWebSocket>& socket,
        const std::shared_ptr<Room>& room,
        const oatpp::String& nickname,
-       v_int64 peerId)
-    : m_socket(socket)
+       v_int64 peerId,
+       bool rabinEncryption = false)
+    : m_outbox(std::make_shared<Outbox>(socket))
+    , m_socket(socket)
     , m_room(room)
     , m_nickname(nickname)
     , m_peerId(peerId)
+    , m_rabinEncryption(rabinEncryption)
     , m_pingPoingCounter(0)
+    , m_messageBucket(*m_appConfig->peerMessagesPerSecond, *m_appConfig->peerMessagesBurst)
+    , m_fileChunkBucket(*m_appConfig->peerFileChunkBytesPerSecond, *m_appConfig->peerFileChunkBytesBurst)
+    , m_chatBucket(*m_appConfig->peerChatMessagesPerSecond, *m_appConfig->peerChatMessagesBurst)
+    , m_fileShareBucket(*m_appConfig->peerFileSharesPerSecond, *m_appConfig->peerFileSharesBurst)
+    , m_typingBucket(*m_appConfig->peerTypingPerSecond, *m_appConfig->peerTypingBurst)
   {}
 
   /**
@@ -104,6 +155,35 @@ public:
    */
   void sendMessageAsync(const oatpp::Object<MessageDto>& message);
 
+  /**
+   * Send already serialized message to peer. Used for broadcasts - the frame is shared, not copied. <br>
+   * The frame is queued to the peer's outbox. If the outbox is full the peer can't keep up - the outbox is closed
+   * and the connection is dropped by the outbox writer or the ping loop, never by the broadcasting thread.
+   * @param frame - serialized `MessageDto`.
+   */
+  void sendFrameAsync(const oatpp::String& frame);
+
+  /**
+   * Send already serialized ephemeral message (typing indicator) to peer. <br>
+   * The frame goes to the lossy lane of the outbox - it is written after all reliable frames,
+   * and an unsent frame from the same sender is replaced by the newer one.
+   * @param frame - serialized `MessageDto`.
+   * @param senderId - id of the peer who sent the message, 0 for messages of the room.
+   */
+  void sendEphemeralFrameAsync(const oatpp::String& frame, v_int64 senderId);
+
+  /**
+   * The peer couldn't keep up - its outbox overflowed and was closed. The connection is to be dropped.
+   * @return
+   */
+  bool isOutboxOverflowed();
+
+  /**
+   * Number of frames waiting to be written to the peer's socket.
+   * @return
+   */
+  v_uint32 getOutboxDepth();
+
   /**
    * Send Websocket-Ping.
    * @return - `true` - ping was sent.
@@ -26,13 +26,30 @@
 
 #include "Room.hpp"
 
+#include "oatpp/encoding/Hex.hpp"
+#include "oatpp/core/base/Environment.hpp"
+
 oatpp::String Room::getName() {
   return m_name;
 }
 
+std::shared_ptr<const RabinBackend> Room::getKey() {
+  return m_key;
+}
+
+const RabinCodec& Room::getCodec() {
+  return m_codec;
+}
+
+std::shared_ptr<const Room::PeerMap> Room::getPeers() {
+  return std::atomic_load(&m_peerById);
+}
+
 void Room::addPeer(const std::shared_ptr<Peer>& peer) {
   std::lock_guard<std::mutex> guard(m_peerByIdLock);
-  m_peerById[peer->getPeerId()] = peer;
+  auto peers = std::make_shared<PeerMap>(*std::atomic_load(&m_peerById));
+  (*peers)[peer->getPeerId()] = peer;
+  std::atomic_store(&m_peerById, std::shared_ptr<const PeerMap>(peers));
 }
 
 void Room::welcomePeer(const std::shared_ptr<Peer>& peer) {
@@ -59,14 +76,23 @@ void Room::onboardPeer(const std::shared_ptr<Peer>& peer) {
 
   infoMessage->peers = {};
 
+  for (auto &it : *getPeers()) {
+    auto p = PeerDto::createShared();
+    p->peerId = it.second->getPeerId();
+    p->peerName = it.second->getNickname();
+    infoMessage->peers->push_back(p);
+  }
+
   {
-    std::lock_guard<std::mutex> guard(m_peerByIdLock);
-    for (auto &it : m_peerById) {
-      auto p = PeerDto::createShared();
-      p->peerId = it.second->getPeerId();
-      p->peerName = it.second->getNickname();
-      infoMessage->peers->push_back(p);
-    }
+    std::vector<uint8_t> modulus(m_key->getBlockSize());
+    m_key->modulusBlock(modulus.data());
+    oatpp::data::stream::BufferOutputStream stream(modulus.size() * 2);
+    oatpp::encoding::Hex::encode(&stream, modulus.data(), (v_buff_size) modulus.size());
+    infoMessage->roomKey = stream.toString();
+  }
+
+  if(m_signingKey) {
+    infoMessage->signingKey = m_signingKey->getModulusHex();
   }
 
   infoMessage->history = getHistory();
@@ -87,9 +113,9 @@ void Room::goodbyePeer(const std::shared_ptr<Peer>& peer) {
 }
 
 std::shared_ptr<Peer> Room::getPeerById(v_int64 peerId) {
-  std::lock_guard<std::mutex> guard(m_peerByIdLock);
-  auto it = m_peerById.find(peerId);
-  if(it != m_peerById.end()) {
+  auto peers = getPeers();
+  auto it = peers->find(peerId);
+  if(it != peers->end()) {
     return it->second;
   }
   return nullptr;
@@ -97,22 +123,30 @@ std::shared_ptr<Peer> Room::getPeerById(v_int64 peerId) {
 
 void Room::removePeerById(v_int64 peerId) {
 
-  std::lock_guard<std::mutex> guard(m_peerByIdLock);
-  auto peer = m_peerById.find(peerId);
-
-  if(peer != m_peerById.end()) {
-
-    {
-      std::lock_guard<std::mutex> guard(m_fileByIdLock);
-      for (const auto &file : peer->second->getFiles()) {
-        file->clearSubscribers();
-        m_fileById.erase(file->getServerFileId());
-      }
+  std::shared_ptr<Peer> peer;
 
+  {
+    std::lock_guard<std::mutex> guard(m_peerByIdLock);
+    auto current = std::atomic_load(&m_peerById);
+    auto it = current->find(peerId);
+    if(it == current->end()) {
+      return;
     }
+    peer = it->second;
+    auto peers = std::make_shared<PeerMap>(*current);
+    peers->erase(peerId);
+    std::atomic_store(&m_peerById, std::shared_ptr<const PeerMap>(peers));
+  }
 
-    m_peerById.erase(peerId);
+  {
+    std::lock_guard<std::mutex> guard(m_typingLock);
+    m_typingPeers.erase(peerId);
+  }
 
+  std::lock_guard<std::mutex> guard(m_fileByIdLock);
+  for (const auto &file : peer->getFiles()) {
+    file->clearSubscribers();
+    m_fileById.erase(file->getServerFileId());
   }
 
 }
@@ -181,23 +215,121 @@ std::shared_ptr<File> Room::getFileById(v_int64 fileId) {
 }
 
 void Room::sendMessageAsync(const oatpp::Object<MessageDto>& message) {
-  std::lock_guard<std::mutex> guard(m_peerByIdLock);
-  for(auto& pair : m_peerById) {
-    pair.second->sendMessageAsync(message);
+  auto frame = m_objectMapper->writeToString(message);
+  auto peers = getPeers();
+  for(auto& pair : *peers) {
+    pair.second->sendFrameAsync(frame);
+  }
+  if(peers->size() > 1) {
+    m_statistics->EVENT_SERIALIZATION_SAVED += peers->size() - 1;
   }
 }
 
+void Room::sendEphemeralMessageAsync(const oatpp::Object<MessageDto>& message) {
+  auto frame = m_objectMapper->writeToString(message);
+  v_int64 senderId = message->peerId ? *message->peerId : 0; // 0 - the room itself
+  auto peers = getPeers();
+  for(auto& pair : *peers) {
+    pair.second->sendEphemeralFrameAsync(frame, senderId);
+  }
+  if(peers->size() > 1) {
+    m_statistics->EVENT_SERIALIZATION_SAVED += peers->size() - 1;
+  }
+}
+
+void Room::addTypingPeer(v_int64 peerId, const oatpp::String& peerName) {
+  std::lock_guard<std::mutex> guard(m_typingLock);
+  m_typingPeers[peerId] = peerName;
+}
+
+void Room::sendTypingPeers() {
+
+  std::unordered_map<v_int64, oatpp::String> typingPeers;
+
+  {
+    std::lock_guard<std::mutex> guard(m_typingLock);
+    if(m_typingPeers.empty()) {
+      return;
+    }
+    std::swap(typingPeers, m_typingPeers);
+  }
+
+  auto message = MessageDto::createShared();
+  message->code = MessageCodes::CODE_PEER_IS_TYPING;
+  message->peers = {};
+  for(auto& pair : typingPeers) {
+    auto p = PeerDto::createShared();
+    p->peerId = pair.first;
+    p->peerName = pair.second;
+    message->peers->push_back(p);
+  }
+
+  sendEphemeralMessageAsync(message);
+
+}
+
+void Room::signPendingMessages() {
+
+  if(!m_signer) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(m_signerLock);
+  auto message = m_signer->signPending(oatpp::base::Environment::getMicroTickCount());
+  if(message) {
+    ++ m_statistics->EVENT_MESSAGE_SIGNED;
+    addHistoryMessage(message);
+    sendMessageAsync(message);
+  }
+
+}
+
+void Room::publishMessage(const oatpp::Object<MessageDto>& message) {
+
+  if(message->peerId) {
+    /* the message ends typing - don't show the sender as typing after the message */
+    std::lock_guard<std::mutex> guard(m_typingLock);
+    m_typingPeers.erase(*message->peerId);
+  }
+
+  if(!m_signer) {
+    addHistoryMessage(message);
+    sendMessageAsync(message);
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(m_signerLock);
+  if(m_signer->sign(message)) {
+    ++ m_statistics->EVENT_MESSAGE_SIGNED;
+  }
+  addHistoryMessage(message);
+  sendMessageAsync(message);
+
+}
+
 void Room::pingAllPeers() {
-  std::lock_guard<std::mutex> guard(m_peerByIdLock);
-  for(auto& pair : m_peerById) {
+  auto peers = getPeers();
+  for(auto& pair : *peers) {
     auto& peer = pair.second;
+    if(peer->isOutboxOverflowed()) { // writer may be stuck in a write to the slow socket
+      OATPP_LOGW("Room", "Outbox of peer %lld in room '%s' overflowed. Disconnecting.", (long long) peer->getPeerId(), m_name->c_str());
+      peer->invalidateSocket();
+      continue;
+    }
     if(!peer->sendPingAsync()) {
       peer->invalidateSocket();
       ++ m_statistics->EVENT_PEER_ZOMBIE_DROPPED;
+      continue;
+    }
+    /* report slow readers before their outbox overflows and they are disconnected */
+    v_uint32 depth = peer->getOutboxDepth();
+    if(depth > 0 && depth >= *m_appConfig->maxPeerQueueFrames / 2) {
+      OATPP_LOGW("Room", "Peer %lld in room '%s' is slow: %u of %u outbox frames queued.",
+                 (long long) peer->getPeerId(), m_name->c_str(), depth, *m_appConfig->maxPeerQueueFrames);
     }
   }
 }
 
 bool Room::isEmpty() {
-  return m_peerById.size() == 0;
+  return getPeers()->empty();
 }
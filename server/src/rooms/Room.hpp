@@ -29,33 +29,52 @@
 
 #include "./File.hpp"
 #include "./Peer.hpp"
+#include "./MessageSigner.hpp"
 #include "dto/DTOs.hpp"
 #include "utils/Statistics.hpp"
+#include "rabin/RabinCodec.hpp"
 
 #include "oatpp/core/macro/component.hpp"
 
 #include <unordered_map>
 #include <list>
+#include <memory>
 
 class Room {
+public:
+  typedef std::unordered_map<v_int64, std::shared_ptr<Peer>> PeerMap;
 private:
   oatpp::String m_name;
+  std::shared_ptr<const RabinBackend> m_key;
+  RabinCodec m_codec;
   std::atomic<v_int64> m_fileIdCounter;
   std::unordered_map<v_int64, std::shared_ptr<File>> m_fileById;
-  std::unordered_map<v_int64, std::shared_ptr<Peer>> m_peerById;
+  std::shared_ptr<const PeerMap> m_peerById; // immutable snapshot, accessed with std::atomic_load/std::atomic_store only
   std::list<oatpp::Object<MessageDto>> m_history;
-  std::mutex m_peerByIdLock;
+  std::mutex m_peerByIdLock; // serializes membership changes (copy-on-write of m_peerById)
   std::mutex m_fileByIdLock;
   std::mutex m_historyLock;
+  std::unordered_map<v_int64, oatpp::String> m_typingPeers; // peerId -> nickname, since the last typing tick
+  std::mutex m_typingLock;
+  std::unique_ptr<MessageSigner> m_signer;
+  std::mutex m_signerLock;
 private:
   OATPP_COMPONENT(oatpp::Object<ConfigDto>, m_appConfig);
   OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+  OATPP_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, m_objectMapper);
+  OATPP_COMPONENT(std::shared_ptr<RabinWilliamsKey>, m_signingKey);
 public:
 
-  Room(const oatpp::String& name)
+  Room(const oatpp::String& name, const std::shared_ptr<const RabinBackend>& key)
     : m_name(name)
+    , m_key(key)
+    , m_codec(key)
     , m_fileIdCounter(1)
+    , m_peerById(std::make_shared<const PeerMap>())
   {
+    if(m_signingKey) {
+      m_signer.reset(new MessageSigner(m_signingKey, m_name, *m_appConfig->signEveryMessages, (v_int64) *m_appConfig->signIntervalMs * 1000));
+    }
     ++ m_statistics->EVENT_ROOM_CREATED;
   }
 
@@ -69,6 +88,25 @@ public:
    */
   oatpp::String getName();
 
+  /**
+   * Get room Rabin key.
+   * @return
+   */
+  std::shared_ptr<const RabinBackend> getKey();
+
+  /**
+   * Get frame codec over the room Rabin key.
+   * @return
+   */
+  const RabinCodec& getCodec();
+
+  /**
+   * Get current snapshot of room peers. <br>
+   * The snapshot is immutable - iterate it without locks. Joins and leaves publish a new snapshot.
+   * @return
+   */
+  std::shared_ptr<const PeerMap> getPeers();
+
   /**
    * Add peer to the room.
    * @param peer
@@ -136,13 +174,49 @@ public:
   std::shared_ptr<File> getFileById(v_int64 fileId);
 
   /**
-   * Send message to all peers in the room.
+   * Send message to all peers in the room. The message is serialized once and the frame is shared by all peers.
    * @param message
    */
   void sendMessageAsync(const oatpp::Object<MessageDto>& message);
 
   /**
-   * Websocket-Ping all peers.
+   * Send ephemeral message (typing indicator) to all peers in the room. <br>
+   * Ephemeral messages may be dropped in favor of a newer message from the same sender and never delay chat messages.
+   * @param message - message with `peerId` of the sender. Messages without `peerId` are sent on behalf of the room.
+   */
+  void sendEphemeralMessageAsync(const oatpp::Object<MessageDto>& message);
+
+  /**
+   * Mark peer as typing. The peer is listed in the next typing message of the room.
+   * @param peerId
+   * @param peerName
+   */
+  void addTypingPeer(v_int64 peerId, const oatpp::String& peerName);
+
+  /**
+   * Send one `CODE_PEER_IS_TYPING` message listing all peers who typed since the last call, and clear the list. <br>
+   * Called by the `Lobby` once in `ConfigDto::typingTickMs`. Nothing is sent if nobody typed.
+   */
+  void sendTypingPeers();
+
+  /**
+   * Sign the pending head of the message chain if the room went quiet after unsigned messages. <br>
+   * The signature is sent to all peers and added to history as a `CODE_CHAIN_SIGNATURE` message.
+   * Called by the `Lobby` on every room tick.
+   */
+  void signPendingMessages();
+
+  /**
+   * Add chat message to history and send it to all peers. <br>
+   * If message signing is enabled the message is appended to the room's signed chain first.
+   * Chaining, history and send are done under one lock, so peers receive messages in chain order.
+   * @param message
+   */
+  void publishMessage(const oatpp::Object<MessageDto>& message);
+
+  /**
+   * Websocket-Ping all peers. Peers with the outbox at least half full are logged as slow,
+   * peers with overflowed outbox are disconnected.
    */
   void pingAllPeers();
 
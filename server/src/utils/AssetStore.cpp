@@ -0,0 +1,504 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "AssetStore.hpp"
+
+#include "utils/Template.hpp"
+
+#include <openssl/evp.h>
+#include <zlib.h>
+
+#ifdef CANCHAT_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include "oatpp/core/base/Environment.hpp"
+
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+constexpr const char* AssetStore::URL_PREFIX;
+constexpr const char* AssetStore::CACHE_CONTROL;
+
+namespace {
+
+/* hex characters of the content hash used in names and ETags */
+constexpr size_t HASH_HEX_SIZE = 16;
+
+/* inotify events that trigger reload */
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+
+/* reload once no events came for this long */
+constexpr int WATCH_SETTLE_MS = 200;
+
+/* how often the watcher checks if it should stop */
+constexpr int WATCH_POLL_MS = 500;
+
+struct ContentType {
+  const char* extension;
+  const char* type;
+};
+
+const ContentType CONTENT_TYPES[] = {
+  {"html", "text/html"},
+  {"js", "text/javascript"},
+  {"css", "text/css"},
+  {"json", "application/json"},
+  {"svg", "image/svg+xml"},
+  {"txt", "text/plain"},
+  {"png", "image/png"},
+  {"jpg", "image/jpeg"},
+  {"ico", "image/x-icon"},
+  {"woff2", "font/woff2"}
+};
+
+const char* getContentType(const std::string& path) {
+  size_t dot = path.rfind('.');
+  if(dot != std::string::npos) {
+    std::string extension = path.substr(dot + 1);
+    for(auto& type : CONTENT_TYPES) {
+      if(extension == type.extension) {
+        return type.type;
+      }
+    }
+  }
+  return "application/octet-stream";
+}
+
+std::string contentHash(const std::string& content) {
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digestSize = 0;
+  if(!EVP_Digest(content.data(), content.size(), digest, &digestSize, EVP_sha256(), nullptr)) {
+    throw std::runtime_error("[AssetStore]: Error. EVP_Digest failed.");
+  }
+
+  static const char* const HEX = "0123456789abcdef";
+  std::string result;
+  result.reserve(HASH_HEX_SIZE);
+  for(size_t i = 0; i < HASH_HEX_SIZE / 2; i ++) {
+    result.push_back(HEX[digest[i] >> 4]);
+    result.push_back(HEX[digest[i] & 15]);
+  }
+  return result;
+
+}
+
+oatpp::String compressGzip(const std::string& data) {
+
+  z_stream stream = {};
+  if(deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16 /* gzip header */, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::runtime_error("[AssetStore]: Error. deflateInit2 failed.");
+  }
+
+  std::string result(deflateBound(&stream, (uLong) data.size()), '\0');
+  stream.next_in = (Bytef*) data.data();
+  stream.avail_in = (uInt) data.size();
+  stream.next_out = (Bytef*) &result[0];
+  stream.avail_out = (uInt) result.size();
+
+  int status = deflate(&stream, Z_FINISH);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  if(status != Z_STREAM_END) {
+    throw std::runtime_error("[AssetStore]: Error. deflate failed.");
+  }
+  return oatpp::String(std::move(result));
+
+}
+
+oatpp::String compressBrotli(const std::string& data) {
+#ifdef CANCHAT_BROTLI
+  size_t size = BrotliEncoderMaxCompressedSize(data.size());
+  if(size == 0) {
+    return nullptr;
+  }
+  std::string result(size, '\0');
+  if(!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_GENERIC,
+                            data.size(), (const uint8_t*) data.data(), &size, (uint8_t*) &result[0]))
+  {
+    throw std::runtime_error("[AssetStore]: Error. BrotliEncoderCompress failed.");
+  }
+  result.resize(size);
+  return oatpp::String(std::move(result));
+#else
+  (void) data;
+  return nullptr;
+#endif
+}
+
+/*
+ * Check if encoding is listed in Accept-Encoding with non-zero q.
+ */
+bool acceptsEncoding(const std::string& header, const char* encoding) {
+
+  size_t pos = 0;
+  while(pos < header.size()) {
+
+    size_t end = header.find(',', pos);
+    if(end == std::string::npos) {
+      end = header.size();
+    }
+
+    std::string item = header.substr(pos, end - pos);
+    pos = end + 1;
+
+    size_t semicolon = item.find(';');
+    std::string name = item.substr(0, semicolon);
+    name.erase(0, name.find_first_not_of(" \t"));
+    name.erase(name.find_last_not_of(" \t") + 1);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    if(name != encoding && name != "*") {
+      continue;
+    }
+
+    if(semicolon != std::string::npos) {
+      size_t q = item.find("q=", semicolon);
+      if(q != std::string::npos && std::strtod(item.c_str() + q + 2, nullptr) <= 0) {
+        continue;
+      }
+    }
+
+    return true;
+
+  }
+
+  return false;
+
+}
+
+}
+
+AssetStore::AssetStore(const oatpp::String& rootPath)
+  : m_rootPath(rootPath)
+  , m_snapshot(std::make_shared<Snapshot>())
+  , m_inotifyFd(-1)
+  , m_watching(false)
+{}
+
+AssetStore::~AssetStore() {
+  m_watching = false;
+  if(m_watchThread.joinable()) {
+    m_watchThread.join();
+  }
+  if(m_inotifyFd >= 0) {
+    close(m_inotifyFd);
+  }
+}
+
+void AssetStore::setVariable(const oatpp::String& name, const oatpp::String& value) {
+  m_variables.push_back({*name, value});
+}
+
+void AssetStore::setUrlVariable(const oatpp::String& name, const oatpp::String& path) {
+  m_urlVariables.push_back({*name, path});
+}
+
+void AssetStore::listFiles(const std::string& directory, std::vector<std::string>& files, std::vector<std::string>& directories) const {
+
+  directories.push_back(directory);
+
+  std::string fullPath = *m_rootPath + "/" + directory;
+  DIR* dir = opendir(fullPath.c_str());
+  if(!dir) {
+    throw std::runtime_error("[AssetStore::listFiles()]: Error. Can't open directory '" + fullPath + "'.");
+  }
+
+  while(dirent* entry = readdir(dir)) {
+
+    std::string name = entry->d_name;
+    if(name.empty() || name[0] == '.') {
+      continue; // skip hidden files, "." and ".."
+    }
+
+    std::string path = directory.empty() ? name : directory + "/" + name;
+    struct stat info;
+    if(stat((*m_rootPath + "/" + path).c_str(), &info) != 0) {
+      continue;
+    }
+
+    if(S_ISDIR(info.st_mode)) {
+      listFiles(path, files, directories);
+    } else if(S_ISREG(info.st_mode)) {
+      files.push_back(path);
+    }
+
+  }
+
+  closedir(dir);
+
+}
+
+oatpp::String AssetStore::substituteVariables(const oatpp::String& text, const Snapshot& snapshot) const {
+
+  auto result = std::make_shared<Template>(text);
+
+  for(auto& variable : m_variables) {
+    result = result->bind(variable.first.c_str(), variable.second);
+  }
+
+  for(auto& variable : m_urlVariables) {
+    auto it = snapshot.byPath.find(*variable.second);
+    if(it == snapshot.byPath.end()) {
+      throw std::runtime_error("[AssetStore::substituteVariables()]: Error. No asset '" + *variable.second + "'.");
+    }
+    result = result->bind(variable.first.c_str(), it->second->url);
+  }
+
+  /* unbound placeholders are kept as is */
+  return result->getText();
+
+}
+
+std::shared_ptr<const AssetStore::Asset> AssetStore::createAsset(const std::string& path, const oatpp::String& content) const {
+
+  std::string hash = contentHash(*content);
+
+  /* insert hash before the extension of the file name */
+  std::string name = path;
+  size_t dot = name.rfind('.');
+  size_t slash = name.rfind('/');
+  if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    name += "." + hash;
+  } else {
+    name.insert(dot, "." + hash);
+  }
+
+  auto asset = std::make_shared<Asset>();
+  asset->path = path;
+  asset->name = name;
+  asset->url = URL_PREFIX + name;
+  asset->contentType = getContentType(path);
+
+  asset->variants[ENCODING_IDENTITY] = {content, "\"" + hash + "\"", nullptr};
+
+  auto gzip = compressGzip(*content);
+  if(gzip->size() < content->size()) {
+    asset->variants[ENCODING_GZIP] = {gzip, "\"" + hash + "-gzip\"", "gzip"};
+  }
+
+  auto brotli = compressBrotli(*content);
+  if(brotli && brotli->size() < content->size()) {
+    asset->variants[ENCODING_BROTLI] = {brotli, "\"" + hash + "-br\"", "br"};
+  }
+
+  return asset;
+
+}
+
+void AssetStore::load() {
+
+  std::vector<std::string> files;
+  std::vector<std::string> directories;
+  listFiles("", files, directories);
+
+  /* HTML last - it may reference hashed URLs of other assets */
+  std::stable_partition(files.begin(), files.end(), [](const std::string& path) {
+    return std::string(getContentType(path)) != "text/html";
+  });
+
+  auto snapshot = std::make_shared<Snapshot>();
+  v_uint64 bytes[ENCODING_COUNT] = {0, 0, 0};
+
+  for(auto& path : files) {
+
+    std::string filename = *m_rootPath + "/" + path;
+    auto content = oatpp::String::loadFromFile(filename.c_str());
+    if(!content) {
+      throw std::runtime_error("[AssetStore::load()]: Error. Can't read asset '" + path + "'.");
+    }
+
+    if(std::string(getContentType(path)) == "text/html") {
+      content = substituteVariables(content, *snapshot);
+    }
+
+    auto asset = createAsset(path, content);
+    snapshot->byPath[path] = asset;
+    snapshot->byName[*asset->name] = asset;
+
+    for(v_int32 i = 0; i < ENCODING_COUNT; i ++) {
+      if(asset->variants[i].body) {
+        bytes[i] += asset->variants[i].body->size();
+      }
+    }
+
+  }
+
+  /* keep hashed names of the replaced assets for pages loaded before the reload */
+  auto previous = std::atomic_load(&m_snapshot);
+  for(auto& entry : previous->byPath) {
+    snapshot->byName.insert({*entry.second->name, entry.second});
+  }
+
+  std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(snapshot));
+
+  m_statistics->ASSET_BYTES_BROTLI = bytes[ENCODING_BROTLI];
+  m_statistics->ASSET_BYTES_GZIP = bytes[ENCODING_GZIP];
+  m_statistics->ASSET_BYTES_IDENTITY = bytes[ENCODING_IDENTITY];
+
+  if(m_inotifyFd >= 0) {
+    addWatches(directories);
+  }
+
+}
+
+void AssetStore::addWatches(const std::vector<std::string>& directories) {
+  /* watching an already watched directory is a no-op, watches of deleted directories are removed by the kernel */
+  for(auto& directory : directories) {
+    std::string path = *m_rootPath + "/" + directory;
+    if(inotify_add_watch(m_inotifyFd, path.c_str(), WATCH_MASK) < 0) {
+      OATPP_LOGE("AssetStore", "Can't watch directory '%s'.", path.c_str());
+    }
+  }
+}
+
+void AssetStore::startWatching() {
+
+  if(m_watching) {
+    return;
+  }
+
+  m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(m_inotifyFd < 0) {
+    throw std::runtime_error("[AssetStore::startWatching()]: Error. inotify_init1 failed.");
+  }
+
+  std::vector<std::string> files;
+  std::vector<std::string> directories;
+  listFiles("", files, directories);
+  addWatches(directories);
+
+  m_watching = true;
+  m_watchThread = std::thread(&AssetStore::runWatcher, this);
+
+}
+
+void AssetStore::runWatcher() {
+
+  alignas(inotify_event) char buffer[4096];
+  pollfd fd = {m_inotifyFd, POLLIN, 0};
+
+  while(m_watching) {
+
+    if(poll(&fd, 1, WATCH_POLL_MS) <= 0) {
+      continue;
+    }
+
+    /* drain events until the directory settles */
+    do {
+      while(read(m_inotifyFd, buffer, sizeof(buffer)) > 0) {}
+    } while(m_watching && poll(&fd, 1, WATCH_SETTLE_MS) > 0);
+
+    if(!m_watching) {
+      break;
+    }
+
+    try {
+      load();
+      ++ m_statistics->EVENT_ASSET_RELOADED;
+      OATPP_LOGI("AssetStore", "Reloaded assets from '%s'.", m_rootPath->c_str());
+    } catch (const std::exception& e) {
+      OATPP_LOGE("AssetStore", "Reload failed, keeping current assets: %s", e.what());
+    }
+
+  }
+
+}
+
+std::shared_ptr<const AssetStore::Asset> AssetStore::getByPath(const oatpp::String& path) const {
+  if(path) {
+    auto snapshot = std::atomic_load(&m_snapshot);
+    auto it = snapshot->byPath.find(*path);
+    if(it != snapshot->byPath.end()) {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const AssetStore::Asset> AssetStore::getByName(const oatpp::String& name) const {
+  if(name) {
+    auto snapshot = std::atomic_load(&m_snapshot);
+    auto it = snapshot->byName.find(*name);
+    if(it != snapshot->byName.end()) {
+      return it->second;
+    }
+  }
+  return nullptr;
+}
+
+const AssetStore::Variant& AssetStore::selectVariant(const Asset& asset, const oatpp::String& acceptEncoding) {
+  if(acceptEncoding) {
+    for(v_int32 i = 0; i < ENCODING_IDENTITY; i ++) {
+      const Variant& variant = asset.variants[i];
+      if(variant.body && acceptsEncoding(*acceptEncoding, variant.encoding)) {
+        return variant;
+      }
+    }
+  }
+  return asset.variants[ENCODING_IDENTITY];
+}
+
+bool AssetStore::matchesETag(const oatpp::String& ifNoneMatch, const oatpp::String& etag) {
+
+  if(!ifNoneMatch || !etag) {
+    return false;
+  }
+
+  /* comma-separated list of (possibly weak) ETags or "*" */
+  const std::string& header = *ifNoneMatch;
+  size_t pos = 0;
+  while(pos < header.size()) {
+    size_t end = header.find(',', pos);
+    if(end == std::string::npos) {
+      end = header.size();
+    }
+    size_t start = header.find_first_not_of(" \t", pos);
+    size_t last = header.find_last_not_of(" \t", end - 1);
+    if(start != std::string::npos && start < end && last >= start) {
+      std::string tag = header.substr(start, last - start + 1);
+      if(tag.compare(0, 2, "W/") == 0) {
+        tag = tag.substr(2);
+      }
+      if(tag == "*" || tag == *etag) {
+        return true;
+      }
+    }
+    pos = end + 1;
+  }
+
+  return false;
+
+}
@@ -0,0 +1,226 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef AssetStore_hpp
+#define AssetStore_hpp
+
+#include "utils/Statistics.hpp"
+
+#include "oatpp/core/Types.hpp"
+#include "oatpp/core/macro/component.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Front assets loaded at startup from the root directory (`FRONT_PATH`). <br>
+ * Every file is kept as is and precompressed with gzip and, if built with brotli (`CANCHAT_BROTLI`), with brotli.
+ * A compressed variant is kept only if it is smaller. Requests pick a variant by `Accept-Encoding`, nothing is compressed per request. <br>
+ * Every asset has a content-hashed name - `chat/chat.js` is also served as `/static/chat/chat.<hash>.js`,
+ * so the response may be cached forever and a changed file gets a new URL. <br>
+ * `%%%NAME%%%` placeholders in HTML files are substituted at load time with values from `setVariable()` and `setUrlVariable()`. <br>
+ * With `startWatching()` the root is watched with inotify and changed files are picked up without restart.
+ * Lookups are lock-free - readers take the current snapshot of assets, reload swaps in a new one.
+ */
+class AssetStore {
+public:
+
+  /**
+   * URL prefix of hashed assets.
+   */
+  static constexpr const char* URL_PREFIX = "/static/";
+
+  /**
+   * `Cache-Control` value for hashed assets.
+   */
+  static constexpr const char* CACHE_CONTROL = "public, max-age=31536000, immutable";
+
+  /**
+   * Content encodings in order of preference.
+   */
+  enum Encoding : v_int32 {
+    ENCODING_BROTLI = 0,
+    ENCODING_GZIP = 1,
+    ENCODING_IDENTITY = 2,
+    ENCODING_COUNT = 3
+  };
+
+  /**
+   * Stored body in one content encoding.
+   */
+  struct Variant {
+
+    /**
+     * Body. `nullptr` - variant is not available.
+     */
+    oatpp::String body;
+
+    /**
+     * Strong ETag (quoted). Differs between encodings.
+     */
+    oatpp::String etag;
+
+    /**
+     * `Content-Encoding` value, `nullptr` for identity.
+     */
+    const char* encoding;
+
+  };
+
+  /**
+   * Loaded asset.
+   */
+  struct Asset {
+
+    /**
+     * Path relative to the store root, e.g. `chat/chat.js`.
+     */
+    oatpp::String path;
+
+    /**
+     * Hashed name, e.g. `chat/chat.0123456789abcdef.js`.
+     */
+    oatpp::String name;
+
+    /**
+     * `URL_PREFIX` + name.
+     */
+    oatpp::String url;
+
+    oatpp::String contentType;
+
+    /**
+     * Variants indexed by `Encoding`. Identity is always available.
+     */
+    Variant variants[ENCODING_COUNT];
+
+  };
+
+private:
+
+  /*
+   * Immutable set of loaded assets. Replaced as a whole on reload.
+   */
+  struct Snapshot {
+    std::unordered_map<std::string, std::shared_ptr<const Asset>> byPath;
+    std::unordered_map<std::string, std::shared_ptr<const Asset>> byName;
+  };
+
+private:
+  oatpp::String m_rootPath;
+  std::vector<std::pair<std::string, oatpp::String>> m_variables;
+  std::vector<std::pair<std::string, oatpp::String>> m_urlVariables;
+  std::shared_ptr<const Snapshot> m_snapshot; // accessed with std::atomic_load/std::atomic_store only
+private:
+  int m_inotifyFd;
+  std::atomic<bool> m_watching;
+  std::thread m_watchThread;
+private:
+  OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+private:
+  void listFiles(const std::string& directory, std::vector<std::string>& files, std::vector<std::string>& directories) const;
+  oatpp::String substituteVariables(const oatpp::String& text, const Snapshot& snapshot) const;
+  std::shared_ptr<const Asset> createAsset(const std::string& path, const oatpp::String& content) const;
+  void addWatches(const std::vector<std::string>& directories);
+  void runWatcher();
+public:
+
+  /**
+   * Constructor.
+   * @param rootPath - directory assets are loaded from.
+   */
+  AssetStore(const oatpp::String& rootPath);
+
+  /**
+   * Value for `%%%name%%%` placeholders in HTML files. Call before `load()`.
+   * @param name
+   * @param value
+   */
+  void setVariable(const oatpp::String& name, const oatpp::String& value);
+
+  /**
+   * Hashed URL of asset for `%%%name%%%` placeholders in HTML files. Call before `load()`.
+   * @param name
+   * @param path - asset path, e.g. `chat/chat.js`.
+   */
+  void setUrlVariable(const oatpp::String& name, const oatpp::String& path);
+
+  /**
+   * Destructor. Stops watching.
+   */
+  ~AssetStore();
+
+  /**
+   * Load all files under the root and atomically replace the current assets.
+   * Hashed names of the replaced assets stay available until the next reload,
+   * so pages loaded before a deploy can still fetch their scripts. <br>
+   * Throws `std::runtime_error` if a file can't be read - current assets are kept then.
+   */
+  void load();
+
+  /**
+   * Watch the root with inotify and `load()` on changes, in a background thread.
+   * Bursts of events (e.g. a deploy copying many files) are coalesced into one reload.
+   * Call after the first `load()`.
+   */
+  void startWatching();
+
+  /**
+   * Find asset by its original path.
+   * @param path - e.g. `chat/chat.js`.
+   * @return - asset or `nullptr`.
+   */
+  std::shared_ptr<const Asset> getByPath(const oatpp::String& path) const;
+
+  /**
+   * Find asset by hashed name (URL without `URL_PREFIX`).
+   * @param name - e.g. `chat/chat.0123456789abcdef.js`.
+   * @return - asset or `nullptr`.
+   */
+  std::shared_ptr<const Asset> getByName(const oatpp::String& name) const;
+
+  /**
+   * Pick the smallest variant acceptable by client.
+   * @param asset
+   * @param acceptEncoding - `Accept-Encoding` header value, may be `nullptr`.
+   * @return
+   */
+  static const Variant& selectVariant(const Asset& asset, const oatpp::String& acceptEncoding);
+
+  /**
+   * Check `If-None-Match` header against ETag.
+   * @param ifNoneMatch - header value, may be `nullptr`.
+   * @param etag - quoted ETag.
+   * @return - `true` if client copy is up to date.
+   */
+  static bool matchesETag(const oatpp::String& ifNoneMatch, const oatpp::String& etag);
+
+};
+
+#endif // AssetStore_hpp
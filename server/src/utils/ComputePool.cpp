@@ -0,0 +1,180 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ComputePool.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// ComputePool::Job
+
+ComputePool::Job::Job(std::function<void()> work)
+  : m_work(std::move(work))
+  , m_done(false)
+  , m_submitTime(0)
+{
+  m_waitList.setListener(this);
+}
+
+void ComputePool::Job::complete() {
+  m_done = true;
+  m_waitList.notifyAll();
+}
+
+void ComputePool::Job::onNewItem(oatpp::async::CoroutineWaitList& list) {
+  if(m_done) {
+    list.notifyAll();
+  }
+}
+
+bool ComputePool::Job::isDone() const {
+  return m_done;
+}
+
+oatpp::async::Action ComputePool::Job::waitAsync() {
+  return oatpp::async::Action::createWaitListAction(&m_waitList);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// ComputePool
+
+ComputePool::ComputePool(v_uint32 threads, v_uint32 capacity)
+  : m_capacity(capacity)
+  , m_running(true)
+{
+  if(threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  if(threads == 0) {
+    threads = 1;
+  }
+  for(v_uint32 i = 0; i < threads; i ++) {
+    m_workers.emplace_back(&ComputePool::runWorker, this);
+  }
+}
+
+ComputePool::~ComputePool() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_running = false;
+  }
+  m_condition.notify_all();
+  for(auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void ComputePool::runWorker() {
+
+  while(true) {
+
+    std::shared_ptr<Job> job;
+
+    {
+      std::unique_lock<std::mutex> guard(m_lock);
+      m_condition.wait(guard, [this] {
+        return !m_running || !m_queue.empty();
+      });
+      if(!m_running) {
+        return;
+      }
+      job = m_queue.front();
+      m_queue.pop_front();
+      -- m_statistics->COMPUTE_QUEUE_DEPTH;
+    }
+
+    m_statistics->COMPUTE_WAIT_MICROS += (v_uint64) (oatpp::base::Environment::getMicroTickCount() - job->m_submitTime);
+
+    try {
+      job->m_work();
+    } catch (const std::exception& e) {
+      OATPP_LOGE("ComputePool", "Job failed: %s", e.what());
+    }
+
+    ++ m_statistics->EVENT_COMPUTE_JOB_DONE;
+    job->complete();
+
+  }
+
+}
+
+std::shared_ptr<ComputePool::Job> ComputePool::submit(std::function<void()> work) {
+
+  auto job = std::make_shared<Job>(std::move(work));
+  job->m_submitTime = oatpp::base::Environment::getMicroTickCount();
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    if(m_queue.size() >= m_capacity) {
+      ++ m_statistics->EVENT_COMPUTE_JOB_REJECTED;
+      return nullptr;
+    }
+    m_queue.push_back(job);
+    ++ m_statistics->COMPUTE_QUEUE_DEPTH;
+  }
+
+  m_condition.notify_one();
+  return job;
+
+}
+
+oatpp::async::CoroutineStarter ComputePool::execute(std::function<void()> work) {
+
+  class ExecuteCoroutine : public oatpp::async::Coroutine<ExecuteCoroutine> {
+  private:
+    ComputePool* m_pool;
+    std::function<void()> m_work;
+    std::shared_ptr<Job> m_job;
+  public:
+
+    ExecuteCoroutine(ComputePool* pool, std::function<void()> work)
+      : m_pool(pool)
+      , m_work(std::move(work))
+    {}
+
+    Action act() override {
+      m_job = m_pool->submit(std::move(m_work));
+      if(!m_job) {
+        return new oatpp::async::Error("Compute pool is overloaded.");
+      }
+      return yieldTo(&ExecuteCoroutine::onWait);
+    }
+
+    Action onWait() {
+      if(m_job->isDone()) {
+        return finish();
+      }
+      return m_job->waitAsync();
+    }
+
+  };
+
+  return ExecuteCoroutine::start(this, std::move(work));
+
+}
+
+v_uint32 ComputePool::getQueueDepth() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return (v_uint32) m_queue.size();
+}
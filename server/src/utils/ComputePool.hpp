@@ -0,0 +1,135 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef ComputePool_hpp
+#define ComputePool_hpp
+
+#include "utils/Statistics.hpp"
+
+#include "oatpp/core/async/Coroutine.hpp"
+#include "oatpp/core/async/CoroutineWaitList.hpp"
+#include "oatpp/core/macro/component.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Bounded thread pool for CPU-heavy work (modular exponentiation) requested by coroutines. <br>
+ * A coroutine submits a job and suspends on the job's wait list instead of running the work
+ * on an executor processor thread, so pings and file relays scheduled on that processor are not delayed.
+ * Queue depth, queue wait time and rejected jobs are reported to `Statistics`.
+ */
+class ComputePool {
+public:
+
+  /**
+   * Submitted work. Resumes the waiting coroutine when done.
+   */
+  class Job : public oatpp::async::CoroutineWaitList::Listener {
+    friend ComputePool;
+  private:
+    std::function<void()> m_work;
+    std::atomic<bool> m_done;
+    oatpp::async::CoroutineWaitList m_waitList;
+    v_int64 m_submitTime;
+  private:
+    void complete();
+  public:
+
+    Job(std::function<void()> work);
+
+    /**
+     * Notify the coroutine if it starts waiting after the job is done.
+     */
+    void onNewItem(oatpp::async::CoroutineWaitList& list) override;
+
+    /**
+     * Check if the job is done.
+     * @return
+     */
+    bool isDone() const;
+
+    /**
+     * Suspend calling coroutine until the job is done.
+     * @return
+     */
+    oatpp::async::Action waitAsync();
+
+  };
+
+private:
+  v_uint32 m_capacity;
+  std::deque<std::shared_ptr<Job>> m_queue;
+  std::mutex m_lock;
+  std::condition_variable m_condition;
+  std::vector<std::thread> m_workers;
+  bool m_running;
+private:
+  OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+private:
+  void runWorker();
+public:
+
+  /**
+   * Constructor. Starts workers.
+   * @param threads - number of worker threads, `0` - number of hardware threads.
+   * @param capacity - max number of queued jobs.
+   */
+  ComputePool(v_uint32 threads, v_uint32 capacity);
+
+  /**
+   * Destructor. Stops workers, queued jobs are not run.
+   */
+  ~ComputePool();
+
+  /**
+   * Queue job.
+   * @param work - work to run on a pool thread. Exceptions are caught and logged - report errors through captured state.
+   * @return - job or `nullptr` if the queue is full.
+   */
+  std::shared_ptr<Job> submit(std::function<void()> work);
+
+  /**
+   * Run work on the pool and resume when it's done.
+   * Fails with async error if the queue is full.
+   * @param work - work to run on a pool thread.
+   * @return
+   */
+  oatpp::async::CoroutineStarter execute(std::function<void()> work);
+
+  /**
+   * Number of queued jobs not yet taken by workers.
+   * @return
+   */
+  v_uint32 getQueueDepth();
+
+};
+
+#endif // ComputePool_hpp
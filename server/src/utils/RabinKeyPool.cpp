@@ -0,0 +1,122 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "RabinKeyPool.hpp"
+
+#include "rabin/RabinKeyGenerator.hpp"
+
+RabinKeyPool::RabinKeyPool(int keyBits, v_uint32 capacity, v_uint32 threads)
+  : m_keyBits(keyBits)
+  , m_capacity(capacity)
+  , m_running(true)
+{
+  if(capacity > 0) {
+    for(v_uint32 i = 0; i < threads; i ++) {
+      m_workers.emplace_back(&RabinKeyPool::runWorker, this);
+    }
+  }
+}
+
+RabinKeyPool::~RabinKeyPool() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_running = false;
+  }
+  m_condition.notify_all();
+  for(auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void RabinKeyPool::runWorker() {
+
+  while(true) {
+
+    {
+      std::unique_lock<std::mutex> guard(m_lock);
+      m_condition.wait(guard, [this] {
+        return !m_running || m_keys.size() < m_capacity;
+      });
+      if(!m_running) {
+        return;
+      }
+    }
+
+    std::shared_ptr<const RabinBackend> key;
+    try {
+      key = RabinKeyGenerator::generate(m_keyBits);
+    } catch (const std::runtime_error& e) {
+      OATPP_LOGE("RabinKeyPool", "Key generation failed: %s", e.what());
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      continue;
+    }
+    ++ m_statistics->EVENT_RABIN_KEY_GENERATED;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if(m_keys.size() < m_capacity) {
+      m_keys.push_back(key);
+    }
+
+  }
+
+}
+
+int RabinKeyPool::getKeyBits() {
+  return m_keyBits;
+}
+
+std::shared_ptr<const RabinBackend> RabinKeyPool::tryAcquire() {
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  if(m_keys.empty()) {
+    ++ m_statistics->EVENT_RABIN_KEY_POOL_MISS;
+    return nullptr;
+  }
+
+  auto key = m_keys.front();
+  m_keys.pop_front();
+  m_condition.notify_one();
+  return key;
+
+}
+
+std::shared_ptr<const RabinBackend> RabinKeyPool::generate() {
+  auto key = RabinKeyGenerator::generate(m_keyBits);
+  ++ m_statistics->EVENT_RABIN_KEY_GENERATED;
+  return key;
+}
+
+void RabinKeyPool::recycle(const std::shared_ptr<const RabinBackend>& key) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  if(m_keys.size() < m_capacity) {
+    m_keys.push_front(key);
+  }
+}
+
+v_uint32 RabinKeyPool::getStockSize() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return (v_uint32) m_keys.size();
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef RabinKeyPool_hpp
+#define RabinKeyPool_hpp
+
+#include "rabin/RabinBackend.hpp"
+#include "utils/Statistics.hpp"
+
+#include "oatpp/core/macro/component.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+/**
+ * Stock of ready-to-use Rabin keys. <br>
+ * Background threads generate keys (see `RabinKeyGenerator`) until the stock is full,
+ * so that rooms created in bursts get their keys without waiting for prime search.
+ */
+class RabinKeyPool {
+private:
+  int m_keyBits;
+  v_uint32 m_capacity;
+  std::deque<std::shared_ptr<const RabinBackend>> m_keys;
+  std::mutex m_lock;
+  std::condition_variable m_condition;
+  std::vector<std::thread> m_workers;
+  bool m_running;
+private:
+  OATPP_COMPONENT(std::shared_ptr<Statistics>, m_statistics);
+private:
+  void runWorker();
+public:
+
+  /**
+   * Constructor. Starts background workers.
+   * @param keyBits - size of the modulus of generated keys.
+   * @param capacity - number of ready keys to keep in stock.
+   * @param threads - number of background workers.
+   */
+  RabinKeyPool(int keyBits, v_uint32 capacity, v_uint32 threads = 1);
+
+  /**
+   * Destructor. Stops background workers.
+   */
+  ~RabinKeyPool();
+
+  /**
+   * Size of the modulus of the keys in this pool.
+   * @return
+   */
+  int getKeyBits();
+
+  /**
+   * Take a key from the stock. Never blocks.
+   * @return - key or `nullptr` if the stock is empty. Then generate the key with `generate()` off the executor threads.
+   */
+  std::shared_ptr<const RabinBackend> tryAcquire();
+
+  /**
+   * Generate new key on the calling thread. Slow at production key sizes - call it from the `ComputePool`.
+   * @return
+   */
+  std::shared_ptr<const RabinBackend> generate();
+
+  /**
+   * Put unused key back to the stock.
+   * @param key
+   */
+  void recycle(const std::shared_ptr<const RabinBackend>& key);
+
+  /**
+   * Number of ready keys in the stock.
+   * @return
+   */
+  v_uint32 getStockSize();
+
+};
+
+#endif // RabinKeyPool_hpp
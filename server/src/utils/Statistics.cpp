@@ -67,12 +67,42 @@ void Statistics::takeSample() {
   point->evPeerZombieDropped = EVENT_PEER_ZOMBIE_DROPPED.load();
   point->evPeerSendMessage = EVENT_PEER_SEND_MESSAGE.load();
   point->evPeerShareFile = EVENT_PEER_SHARE_FILE.load();
+  point->evSerializationSaved = EVENT_SERIALIZATION_SAVED.load();
+  point->evPeerRateDeferred = EVENT_PEER_RATE_DEFERRED.load();
+  point->evPeerRateLimited = EVENT_PEER_RATE_LIMITED.load();
+
+  point->peerOutboxFrames = PEER_OUTBOX_FRAMES.load();
+  v_uint64 outboxMaxDepth = PEER_OUTBOX_MAX_DEPTH.exchange(0);
+  if(!point->peerOutboxMaxDepth || *point->peerOutboxMaxDepth < outboxMaxDepth) {
+    point->peerOutboxMaxDepth = outboxMaxDepth;
+  }
+  point->evPeerOutboxOverflow = EVENT_PEER_OUTBOX_OVERFLOW.load();
+  point->evSocketWritesSaved = EVENT_SOCKET_WRITES_SAVED.load();
+  point->evEphemeralDropped = EVENT_EPHEMERAL_DROPPED.load();
 
   point->evRoomCreated = EVENT_ROOM_CREATED.load();
   point->evRoomDeleted = EVENT_ROOM_DELETED.load();
 
   point->fileServedBytes = FILE_SERVED_BYTES.load();
 
+  point->evRabinKeyGenerated = EVENT_RABIN_KEY_GENERATED.load();
+  point->evRabinKeyPoolMiss = EVENT_RABIN_KEY_POOL_MISS.load();
+  point->evMessageSigned = EVENT_MESSAGE_SIGNED.load();
+
+  point->evComputeJobDone = EVENT_COMPUTE_JOB_DONE.load();
+  point->evComputeJobRejected = EVENT_COMPUTE_JOB_REJECTED.load();
+  point->computeWaitMicros = COMPUTE_WAIT_MICROS.load();
+  point->computeQueueDepth = COMPUTE_QUEUE_DEPTH.load();
+
+  point->assetBytesIdentity = ASSET_BYTES_IDENTITY.load();
+  point->assetBytesGzip = ASSET_BYTES_GZIP.load();
+  point->assetBytesBrotli = ASSET_BYTES_BROTLI.load();
+  point->evAssetServedIdentity = EVENT_ASSET_SERVED_IDENTITY.load();
+  point->evAssetServedGzip = EVENT_ASSET_SERVED_GZIP.load();
+  point->evAssetServedBrotli = EVENT_ASSET_SERVED_BROTLI.load();
+  point->evAssetNotModified = EVENT_ASSET_NOT_MODIFIED.load();
+  point->evAssetReloaded = EVENT_ASSET_RELOADED.load();
+
 }
 
 oatpp::String Statistics::getJsonData() {
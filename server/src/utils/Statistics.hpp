@@ -43,12 +43,39 @@ public:
   std::atomic<v_uint64> EVENT_PEER_ZOMBIE_DROPPED {0};          // On Disconnected due to failed ping counter
   std::atomic<v_uint64> EVENT_PEER_SEND_MESSAGE   {0};          // Sent messages counter
   std::atomic<v_uint64> EVENT_PEER_SHARE_FILE     {0};          // Shared files counter
+  std::atomic<v_uint64> EVENT_SERIALIZATION_SAVED {0};          // Message serializations saved by sharing one frame in broadcasts
+  std::atomic<v_uint64> EVENT_PEER_RATE_DEFERRED  {0};          // Inbound messages delayed by the peer rate limit
+  std::atomic<v_uint64> EVENT_PEER_RATE_LIMITED   {0};          // Inbound messages over a per-code rate limit (dropped or peer disconnected)
+
+  std::atomic<v_uint64> PEER_OUTBOX_FRAMES          {0};        // Frames currently queued in all peer outboxes
+  std::atomic<v_uint64> PEER_OUTBOX_MAX_DEPTH       {0};        // Deepest single peer outbox since the last sample (max per stat point)
+  std::atomic<v_uint64> EVENT_PEER_OUTBOX_OVERFLOW  {0};        // Frames rejected by a full outbox (peer disconnected)
+  std::atomic<v_uint64> EVENT_SOCKET_WRITES_SAVED   {0};        // Socket writes saved by coalescing small frames
+  std::atomic<v_uint64> EVENT_EPHEMERAL_DROPPED     {0};        // Unsent typing indicators replaced by a newer one from the same sender
 
   std::atomic<v_uint64> EVENT_ROOM_CREATED        {0};          // On room created
   std::atomic<v_uint64> EVENT_ROOM_DELETED        {0};          // On room deleted
 
   std::atomic<v_uint64> FILE_SERVED_BYTES         {0};          // Overall shared files served bytes
 
+  std::atomic<v_uint64> EVENT_RABIN_KEY_GENERATED {0};          // Rabin keys generated
+  std::atomic<v_uint64> EVENT_RABIN_KEY_POOL_MISS {0};          // Rabin key requested while key pool was empty
+  std::atomic<v_uint64> EVENT_MESSAGE_SIGNED      {0};          // Chat messages signed with the server key
+
+  std::atomic<v_uint64> EVENT_COMPUTE_JOB_DONE     {0};         // Jobs run by the compute pool
+  std::atomic<v_uint64> EVENT_COMPUTE_JOB_REJECTED {0};         // Jobs rejected because the compute queue was full
+  std::atomic<v_uint64> COMPUTE_WAIT_MICROS        {0};         // Overall time jobs spent in the compute queue
+  std::atomic<v_uint64> COMPUTE_QUEUE_DEPTH        {0};         // Jobs currently in the compute queue
+
+  std::atomic<v_uint64> ASSET_BYTES_IDENTITY        {0};        // Overall size of loaded front assets
+  std::atomic<v_uint64> ASSET_BYTES_GZIP            {0};        // Overall size of gzip variants of front assets
+  std::atomic<v_uint64> ASSET_BYTES_BROTLI          {0};        // Overall size of brotli variants of front assets
+  std::atomic<v_uint64> EVENT_ASSET_SERVED_IDENTITY {0};        // Front assets served uncompressed
+  std::atomic<v_uint64> EVENT_ASSET_SERVED_GZIP     {0};        // Front assets served gzip-compressed
+  std::atomic<v_uint64> EVENT_ASSET_SERVED_BROTLI   {0};        // Front assets served brotli-compressed
+  std::atomic<v_uint64> EVENT_ASSET_NOT_MODIFIED    {0};        // Front asset requests answered with 304
+  std::atomic<v_uint64> EVENT_ASSET_RELOADED        {0};        // Front assets reloaded after a change on disk
+
 private:
   oatpp::parser::json::mapping::ObjectMapper m_objectMapper;
 private:
@@ -0,0 +1,153 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "Template.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char* const MARKER = "%%%";
+constexpr size_t MARKER_SIZE = 3;
+
+bool isNameChar(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+}
+
+Template::Template(const oatpp::String& text)
+  : m_text(text ? *text : std::string())
+  , m_literalSize(0)
+{
+
+  size_t literalStart = 0;
+  size_t pos = 0;
+
+  while((pos = m_text.find(MARKER, pos)) != std::string::npos) {
+
+    size_t nameStart = pos + MARKER_SIZE;
+    size_t nameEnd = nameStart;
+    while(nameEnd < m_text.size() && isNameChar(m_text[nameEnd])) {
+      ++ nameEnd;
+    }
+
+    if(nameEnd == nameStart || m_text.compare(nameEnd, MARKER_SIZE, MARKER) != 0) {
+      ++ pos; // not a placeholder - keep as text
+      continue;
+    }
+
+    addLiteral(literalStart, pos - literalStart);
+
+    std::string name = m_text.substr(nameStart, nameEnd - nameStart);
+    v_int32 variable = getVariableIndex(name.c_str());
+    if(variable < 0) {
+      variable = (v_int32) m_variables.size();
+      m_variables.push_back(name);
+    }
+    m_segments.push_back({0, 0, variable});
+
+    pos = nameEnd + MARKER_SIZE;
+    literalStart = pos;
+
+  }
+
+  addLiteral(literalStart, m_text.size() - literalStart);
+
+}
+
+void Template::addLiteral(size_t offset, size_t size) {
+  if(size > 0) {
+    m_segments.push_back({offset, size, -1});
+    m_literalSize += size;
+  }
+}
+
+std::shared_ptr<Template> Template::loadFromFile(const char* filename) {
+  auto text = oatpp::String::loadFromFile(filename);
+  if(!text) {
+    return nullptr;
+  }
+  return std::make_shared<Template>(text);
+}
+
+v_int32 Template::getVariableIndex(const char* name) const {
+  for(size_t i = 0; i < m_variables.size(); i ++) {
+    if(m_variables[i] == name) {
+      return (v_int32) i;
+    }
+  }
+  return -1;
+}
+
+oatpp::String Template::getText() const {
+  return oatpp::String(m_text);
+}
+
+v_int32 Template::getVariablesCount() const {
+  return (v_int32) m_variables.size();
+}
+
+oatpp::String Template::render(const std::vector<oatpp::String>& values) const {
+
+  if(values.size() < m_variables.size()) {
+    throw std::runtime_error("[Template::render()]: Error. Not enough values.");
+  }
+
+  size_t size = m_literalSize;
+  for(auto& segment : m_segments) {
+    if(segment.variable >= 0 && values[segment.variable]) {
+      size += values[segment.variable]->size();
+    }
+  }
+
+  std::string result(size, '\0');
+  char* out = &result[0];
+
+  for(auto& segment : m_segments) {
+    if(segment.variable < 0) {
+      std::memcpy(out, m_text.data() + segment.offset, segment.size);
+      out += segment.size;
+    } else if(values[segment.variable]) {
+      auto& value = values[segment.variable];
+      std::memcpy(out, value->data(), value->size());
+      out += value->size();
+    }
+  }
+
+  return oatpp::String(std::move(result));
+
+}
+
+std::shared_ptr<Template> Template::bind(const char* name, const oatpp::String& value) const {
+  std::vector<oatpp::String> values;
+  values.reserve(m_variables.size());
+  for(auto& variable : m_variables) {
+    values.push_back(variable == name ? value : oatpp::String(MARKER + variable + MARKER));
+  }
+  return std::make_shared<Template>(render(values));
+}
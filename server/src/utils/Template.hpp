@@ -0,0 +1,107 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef Template_hpp
+#define Template_hpp
+
+#include "oatpp/core/Types.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * Text template with `%%%NAME%%%` placeholders (`NAME` - uppercase letters, digits and `_`). <br>
+ * The text is split at placeholders once, on construction. Rendering computes the exact output size
+ * and copies literal segments and values into a single buffer.
+ */
+class Template {
+private:
+
+  struct Segment {
+    size_t offset;
+    size_t size;
+    v_int32 variable; // -1 - literal text
+  };
+
+private:
+  std::string m_text;
+  std::vector<Segment> m_segments;
+  std::vector<std::string> m_variables;
+  size_t m_literalSize;
+private:
+  void addLiteral(size_t offset, size_t size);
+public:
+
+  /**
+   * Constructor. Parses the text.
+   * @param text - template text.
+   */
+  Template(const oatpp::String& text);
+
+  /**
+   * Load and parse template file.
+   * @param filename
+   * @return - template or `nullptr` if file can't be read.
+   */
+  static std::shared_ptr<Template> loadFromFile(const char* filename);
+
+  /**
+   * Index of the variable in the `render()` values.
+   * @param name - variable name without `%%%`.
+   * @return - index or `-1` if template has no such placeholder.
+   */
+  v_int32 getVariableIndex(const char* name) const;
+
+  /**
+   * Template text with placeholders.
+   * @return
+   */
+  oatpp::String getText() const;
+
+  /**
+   * Number of distinct variables. Variables are indexed in order of first appearance.
+   * @return
+   */
+  v_int32 getVariablesCount() const;
+
+  /**
+   * Render template.
+   * @param values - one value per variable, indexed as `getVariableIndex()`. `nullptr` renders as empty string.
+   * @return
+   */
+  oatpp::String render(const std::vector<oatpp::String>& values) const;
+
+  /**
+   * Substitute one variable, keep other placeholders. Used to bake in values known at load time.
+   * @param name - variable name without `%%%`.
+   * @param value
+   * @return - new template.
+   */
+  std::shared_ptr<Template> bind(const char* name, const oatpp::String& value) const;
+
+};
+
+#endif // Template_hpp
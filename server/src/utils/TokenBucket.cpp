@@ -0,0 +1,67 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "TokenBucket.hpp"
+
+#include <algorithm>
+
+TokenBucket::TokenBucket(v_uint32 rate, v_uint32 burst)
+  : m_rate(rate)
+  , m_burst(std::max<v_uint32>(burst, 1))
+  , m_tokens(m_burst)
+  , m_lastTick(0)
+{}
+
+void TokenBucket::refill(v_int64 nowMicro) {
+  if(m_lastTick != 0 && nowMicro > m_lastTick) {
+    m_tokens = std::min(m_burst, m_tokens + (v_float64) (nowMicro - m_lastTick) * m_rate / 1000000.0);
+  }
+  m_lastTick = nowMicro;
+}
+
+bool TokenBucket::tryTake(v_int64 nowMicro) {
+  if(m_rate == 0) {
+    return true;
+  }
+  refill(nowMicro);
+  if(m_tokens < 1) {
+    return false;
+  }
+  m_tokens -= 1;
+  return true;
+}
+
+v_int64 TokenBucket::take(v_int64 nowMicro, v_uint32 count) {
+  if(m_rate == 0) {
+    return 0;
+  }
+  refill(nowMicro);
+  m_tokens -= count;
+  if(m_tokens >= 0) {
+    return 0;
+  }
+  return (v_int64) (-m_tokens * 1000000.0 / m_rate) + 1;
+}
@@ -0,0 +1,71 @@
+/***************************************************************************
+ *
+ * Project:   ______                ______ _
+ *           / _____)              / _____) |          _
+ *          | /      ____ ____ ___| /     | | _   ____| |_
+ *          | |     / _  |  _ (___) |     | || \ / _  |  _)
+ *          | \____( ( | | | | |  | \_____| | | ( ( | | |__
+ *           \______)_||_|_| |_|   \______)_| |_|\_||_|\___)
+ *
+ *
+ * Copyright 2020-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef TokenBucket_hpp
+#define TokenBucket_hpp
+
+#include "oatpp/core/Types.hpp"
+
+/**
+ * Token bucket rate limiter. <br>
+ * Refills at `rate` tokens per second up to `burst` tokens. A rate of zero disables the limit. <br>
+ * Not thread-safe - one bucket is used by one reader (e.g. one peer socket).
+ */
+class TokenBucket {
+private:
+  v_float64 m_rate;
+  v_float64 m_burst;
+  v_float64 m_tokens;
+  v_int64 m_lastTick;
+private:
+  void refill(v_int64 nowMicro);
+public:
+
+  /**
+   * Constructor. The bucket starts full.
+   * @param rate - tokens per second. `0` - unlimited.
+   * @param burst - bucket capacity. Values below `1` are treated as `1`.
+   */
+  TokenBucket(v_uint32 rate, v_uint32 burst);
+
+  /**
+   * Take a token if available.
+   * @param nowMicro - current time in microseconds.
+   * @return - `false` if the bucket is empty. No token is taken then.
+   */
+  bool tryTake(v_int64 nowMicro);
+
+  /**
+   * Take tokens, going into debt if the bucket doesn't have enough.
+   * @param nowMicro - current time in microseconds.
+   * @param count - number of tokens, e.g. bytes for a byte-rate bucket.
+   * @return - microseconds the caller should wait before acting, `0` if the tokens were available.
+   */
+  v_int64 take(v_int64 nowMicro, v_uint32 count = 1);
+
+};
+
+#endif // TokenBucket_hpp
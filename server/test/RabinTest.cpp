@@ -0,0 +1,352 @@
+#include "RabinTest.hpp"
+
+#include "rabin/rabin.hpp"
+#include "rabin/BigRabinKey.hpp"
+#include "rabin/FixedRabinKey.hpp"
+#include "rabin/RabinWilliamsKey.hpp"
+#include "rooms/MessageSigner.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+/*
+ * Reference - the original `int` implementation of the toy Rabin key.
+ * Valid only while n^2 fits into int.
+ */
+class LegacyRabin {
+private:
+  int p;
+  int q;
+  int n;
+
+  int modulo(int a, int b) {
+    return a >= 0 ? a % b : (b - (a % b < 0 ? -(a % b) : a % b)) % b;
+  }
+
+  int mod(int k, int b, int m) {
+    int a = 1;
+    while (k > 0) {
+      if (k % 2 == 1) {
+        a = (a * b) % m;
+      }
+      b = (b * b) % m;
+      k /= 2;
+    }
+    return a;
+  }
+
+  void eea(int a, int b, int& x, int& y) {
+    if (b > a) {
+      int temp = a;
+      a = b;
+      b = temp;
+    }
+    int cx = 0, cy = 1, lastx = 1, lasty = 0;
+    while (b != 0) {
+      int t = a / b;
+      int r = a % b;
+      a = b;
+      b = r;
+      int tx = cx; cx = lastx - t * cx; lastx = tx;
+      int ty = cy; cy = lasty - t * cy; lasty = ty;
+    }
+    x = lastx;
+    y = lasty;
+  }
+
+public:
+
+  LegacyRabin(int prime1, int prime2) : p(prime1), q(prime2), n(prime1 * prime2) {}
+
+  int encrypt(int m) {
+    return (m * m) % n;
+  }
+
+  void roots(int c, int out[4]) {
+    int mp = mod((p + 1) / 4, c % p, p);
+    int mq = mod((q + 1) / 4, c % q, q);
+    int x, y;
+    eea(p, q, x, y);
+    if(q > p) { int t = x; x = y; y = t; }
+    int pp = x * p * mq;
+    int qq = y * q * mp;
+    int r = modulo(pp + qq, n);
+    int s = modulo(pp - qq, n);
+    out[0] = r;
+    out[1] = (n - r) % n;
+    out[2] = s;
+    out[3] = (n - s) % n;
+  }
+
+};
+
+template<typename Word>
+bool sameRoots(const Word a[4], const int b[4]) {
+  for(int i = 0; i < 4; i ++) {
+    bool found = false;
+    for(int j = 0; j < 4; j ++) {
+      if(a[i] == (Word) b[j]) {
+        found = true;
+        break;
+      }
+    }
+    if(!found) return false;
+  }
+  return true;
+}
+
+template<typename Word>
+void checkAgainstLegacy(int p, int q) {
+  BasicRabinKey<Word> key(p, q);
+  LegacyRabin legacy(p, q);
+  int n = p * q;
+  for(int m = 0; m < n; m ++) {
+    int c = legacy.encrypt(m);
+    OATPP_ASSERT(key.encrypt(m) == (Word) c);
+    Word r[4];
+    int lr[4];
+    key.roots(c, r);
+    legacy.roots(c, lr);
+    OATPP_ASSERT(sameRoots(r, lr));
+  }
+}
+
+template<typename Word>
+void checkRoundTrip(Word p, Word q) {
+  BasicRabinKey<Word> key(p, q);
+  Word n = key.getN();
+  Word step = n / 10007 + 1;
+  for(Word m = 1; m < n - step; m += step) {
+    Word r[4];
+    key.roots(key.encrypt(m), r);
+    OATPP_ASSERT(r[0] == m || r[1] == m || r[2] == m || r[3] == m);
+  }
+}
+
+}
+
+void RabinTest::onRun() {
+
+  const int smallKeys[][2] = {{167, 151}, {7, 11}, {19, 23}, {43, 47}, {139, 131}};
+
+  for(auto& k : smallKeys) {
+    OATPP_LOGD(TAG, "Compare with legacy implementation p=%d, q=%d", k[0], k[1]);
+    checkAgainstLegacy<uint32_t>(k[0], k[1]);
+    checkAgainstLegacy<uint64_t>(k[0], k[1]);
+  }
+
+  {
+    RabinKey key(167, 151);
+    for(int m = 0; m < 128; m ++) {
+      OATPP_ASSERT(key.decrypt(key.encrypt(m)) == m);
+    }
+  }
+
+  OATPP_LOGD(TAG, "Batch encryption, AVX2=%d", (int) RabinBatch::isAvx2Enabled());
+  {
+    std::vector<uint8_t> bytes(1000);
+    for(size_t i = 0; i < bytes.size(); i ++) {
+      bytes[i] = (uint8_t) (i * 131 + 17);
+    }
+    std::vector<uint32_t> out(bytes.size());
+    auto keys = {RabinKey(7, 11), RabinKey(167, 151), RabinKey(46327, 46307), RabinKey(2147483647ULL, 2147483587ULL)};
+    for(auto& key : keys) {
+      key.encryptBatch(bytes.data(), bytes.size() - 3, out.data());
+      for(size_t i = 0; i < bytes.size() - 3; i ++) {
+        OATPP_ASSERT(out[i] == key.encrypt(bytes[i]));
+      }
+    }
+  }
+
+  OATPP_LOGD(TAG, "Batch decryption");
+  {
+    RabinKey key(2147483647ULL, 2147483587ULL);
+    const size_t count = 3 * RabinKey::DECRYPT_MIN_PER_THREAD + 5;
+    std::vector<uint64_t> c(count);
+    std::vector<int8_t> jacobi(count);
+    std::vector<uint64_t> m(count);
+    uint64_t step = key.getN() / 2 / count;
+    for(size_t i = 0; i < count; i ++) {
+      m[i] = i * step + i % 7;
+      c[i] = key.encrypt(m[i]);
+      jacobi[i] = (int8_t) key.jacobi(m[i]);
+    }
+    std::vector<uint64_t> out(count);
+    for(unsigned threads : {1u, 4u}) {
+      key.decryptBatch(c.data(), jacobi.data(), count, out.data(), threads);
+      OATPP_ASSERT(out == m);
+    }
+  }
+
+  OATPP_LOGD(TAG, "Compile-time key");
+  {
+    typedef FixedRabinKey<2147483647ULL, 2147483587ULL> FixedKey;
+    static_assert(FixedKey::MODULUS == 2147483647ULL * 2147483587ULL, "Wrong modulus");
+    static_assert(!RabinConstexpr::isPrime(2147483647ULL * 2147483587ULL), "Wrong primality test");
+    FixedKey fixed;
+    RabinKey key(2147483587ULL, 2147483647ULL);
+    OATPP_ASSERT(fixed.getP() == key.getP() && fixed.getQ() == key.getQ() && fixed.getN() == key.getN());
+    uint64_t step = key.getN() / 10007 + 1;
+    for(uint64_t m = 1; m < key.getN() - step; m += step) {
+      uint64_t c = key.encrypt(m);
+      OATPP_ASSERT(fixed.encrypt(m) == c);
+      uint64_t r[4], fr[4];
+      key.roots(c, r);
+      fixed.roots(c, fr);
+      OATPP_ASSERT(std::equal(r, r + 4, fr));
+      OATPP_ASSERT(fixed.decryptBlock(c, fixed.jacobi(m)) == key.decryptBlock(c, key.jacobi(m)));
+    }
+
+    typedef FixedRabinKey<167, 151> SmallFixedKey;
+    std::shared_ptr<const RabinBackend> backend = std::make_shared<SmallRabinBackend<SmallFixedKey>>(std::make_shared<SmallFixedKey>());
+    RabinCryptosystem cryptosystem(backend, "Rabin Cryptosystem");
+    cryptosystem.encode();
+    OATPP_ASSERT(cryptosystem.decode() == "Rabin Cryptosystem");
+  }
+
+  OATPP_LOGD(TAG, "Block format, all byte values");
+  {
+    std::string text;
+    for(int i = 0; i < 256; i ++) {
+      text.push_back((char) i);
+    }
+    auto keys = {std::make_shared<RabinKey>(167, 151), std::make_shared<RabinKey>(2147483647ULL, 2147483587ULL)};
+    for(auto& key : keys) {
+      RabinCryptosystem cryptosystem(key, text);
+      auto frame = cryptosystem.encode();
+      RabinCodec codec(std::make_shared<SmallRabinBackend<RabinKey>>(key));
+      OATPP_ASSERT(frame.size() == codec.getEncodedSize(text.size()));
+      OATPP_ASSERT(cryptosystem.decode() == text);
+    }
+  }
+
+  OATPP_LOGD(TAG, "Round trip 31-bit modulus");
+  checkRoundTrip<uint32_t>(46327, 46307);
+
+  OATPP_LOGD(TAG, "Round trip 62-bit modulus");
+  checkRoundTrip<uint64_t>(2147483647ULL, 2147483587ULL);
+
+  OATPP_LOGD(TAG, "Rabin-Williams signatures");
+  {
+    auto key = RabinWilliamsKey::generate(512);
+    OATPP_ASSERT(BN_num_bits(key->getN()) == 512);
+    std::vector<uint8_t> signature(key->getSignatureSize());
+    for(int i = 0; i < 64; i ++) {
+      uint8_t digest[32];
+      for(int j = 0; j < 32; j ++) {
+        digest[j] = (uint8_t) (i * 37 + j);
+      }
+      key->sign(digest, sizeof(digest), signature.data());
+      OATPP_ASSERT(key->verify(digest, sizeof(digest), signature.data()));
+      OATPP_ASSERT(RabinWilliamsKey::verify(key->getN(), digest, sizeof(digest), signature.data(), signature.size()));
+      digest[i % 32] ^= 1;
+      OATPP_ASSERT(!key->verify(digest, sizeof(digest), signature.data()));
+      digest[i % 32] ^= 1;
+      signature[signature.size() - 1] ^= 1;
+      OATPP_ASSERT(!key->verify(digest, sizeof(digest), signature.data()));
+    }
+
+    /* the chain covers the author and the code - a signed message can't be re-attributed */
+    uint8_t prev[MessageSigner::CHAIN_SIZE] = {0};
+    uint8_t expected[MessageSigner::CHAIN_SIZE];
+    uint8_t actual[MessageSigner::CHAIN_SIZE];
+    auto message = MessageDto::createShared();
+    message->code = MessageCodes::CODE_PEER_MESSAGE;
+    message->peerId = (v_int64) 1;
+    message->peerName = "alice";
+    message->timestamp = (v_int64) 1000;
+    message->seq = (v_int64) 1;
+    message->message = "hello";
+    MessageSigner::chainStep(prev, message, expected);
+
+    message->peerName = "mallory";
+    MessageSigner::chainStep(prev, message, actual);
+    OATPP_ASSERT(std::memcmp(expected, actual, sizeof(actual)) != 0);
+
+    message->peerName = "alice";
+    message->code = MessageCodes::CODE_PEER_MESSAGE_FILE;
+    MessageSigner::chainStep(prev, message, actual);
+    OATPP_ASSERT(std::memcmp(expected, actual, sizeof(actual)) != 0);
+
+    message->code = MessageCodes::CODE_PEER_MESSAGE;
+    MessageSigner::chainStep(prev, message, actual);
+    OATPP_ASSERT(std::memcmp(expected, actual, sizeof(actual)) == 0);
+  }
+
+  OATPP_LOGD(TAG, "Big key backend");
+  {
+    BIGNUM* p = BN_new();
+    BIGNUM* q = BN_new();
+    BIGNUM* add = BN_new();
+    BIGNUM* rem = BN_new();
+    BN_set_word(add, 4);
+    BN_set_word(rem, 3);
+    OATPP_ASSERT(BN_generate_prime_ex(p, 512, 0, add, rem, nullptr));
+    OATPP_ASSERT(BN_generate_prime_ex(q, 512, 0, add, rem, nullptr));
+    std::shared_ptr<const RabinBackend> key = std::make_shared<BigRabinKey>(p, q);
+    BN_free(p);
+    BN_free(q);
+    BN_free(add);
+    BN_free(rem);
+
+    OATPP_ASSERT(key->getModulusBits() >= 1023);
+
+    RabinCryptosystem big(key, "Rabin Cryptosystem");
+    OATPP_ASSERT(big.encode().size() == RabinCodec::HEADER_SIZE + (size_t) key->getModulusBits() / 8 + 1);
+    OATPP_ASSERT(big.decode() == "Rabin Cryptosystem");
+
+    std::string text(1000, '\0');
+    for(size_t i = 0; i < text.size(); i ++) {
+      text[i] = (char) (i * 31 + 7);
+    }
+    RabinCodec codec(key);
+    OATPP_ASSERT(codec.getPayloadSize() + RabinCodec::REDUNDANCY_SIZE == (size_t) (key->getModulusBits() - 2) / 8);
+    auto frame = codec.encode(text.data(), text.size());
+    OATPP_ASSERT(codec.decode(frame.data(), frame.size()) == text);
+
+    /* streaming in uneven pieces gives the same frame and plaintext */
+    RabinCodec::Encoder encoder(codec, text.size());
+    std::vector<uint8_t> buffer(encoder.getMaxOutputSize(text.size()));
+    std::string streamed;
+    for(size_t pos = 0, piece = 1; pos < text.size(); pos += piece, piece = piece * 3 % 257 + 1) {
+      size_t size = std::min(piece, text.size() - pos);
+      auto written = encoder.write(text.data() + pos, size, buffer.data());
+      streamed.append((const char*) buffer.data(), written);
+    }
+    OATPP_ASSERT(encoder.isFinished());
+    OATPP_ASSERT(streamed == frame);
+
+    RabinCodec::Decoder decoder(codec);
+    std::string plain;
+    for(size_t pos = 0, piece = 5; pos < frame.size(); pos += piece, piece = piece * 7 % 301 + 1) {
+      size_t size = std::min(piece, frame.size() - pos);
+      auto written = decoder.write(frame.data() + pos, size, buffer.data());
+      plain.append((const char*) buffer.data(), written);
+    }
+    OATPP_ASSERT(decoder.isFinished());
+    OATPP_ASSERT(plain == text);
+
+    /* flipped Jacobi hint selects a wrong root - it must be rejected, not returned */
+    std::string hello = "Rabin Cryptosystem";
+    auto forged = codec.encode(hello.data(), hello.size());
+    int bits = key->getModulusBits();
+    forged[RabinCodec::HEADER_SIZE + codec.getWireBlockSize() - 1 - bits / 8] ^= (char) (1 << (bits % 8));
+    bool rejected = false;
+    try {
+      codec.decode(forged.data(), forged.size());
+    } catch (const std::runtime_error& e) {
+      rejected = true;
+    }
+    OATPP_ASSERT(rejected);
+
+    std::shared_ptr<const RabinBackend> small = std::make_shared<SmallRabinBackend<RabinKey>>(std::make_shared<RabinKey>(167, 151));
+    RabinCryptosystem viaBackend(small, "Rabin Cryptosystem");
+    viaBackend.encode();
+    OATPP_ASSERT(viaBackend.decode() == "Rabin Cryptosystem");
+  }
+
+}
@@ -0,0 +1,16 @@
+#ifndef RABIN_TEST_HPP
+#define RABIN_TEST_HPP
+
+
+#include "oatpp-test/UnitTest.hpp"
+
+class RabinTest : public oatpp::test::UnitTest {
+public:
+
+  RabinTest():UnitTest("TEST[RabinTest]"){}
+  void onRun() override;
+
+};
+
+
+#endif //RABIN_TEST_HPP
@@ -1,5 +1,6 @@
 
 #include "WSTest.hpp"
+#include "RabinTest.hpp"
 
 #include "oatpp-test/UnitTest.hpp"
 #include <iostream>
@@ -7,6 +8,7 @@
 
 void runTests() {
   OATPP_RUN_TEST(WSTest);
+  OATPP_RUN_TEST(RabinTest);
 }
 
 int main() {